@@ -0,0 +1,77 @@
+#ifndef __AUTO_OBJECT_SLOTS_API_H__
+#define __AUTO_OBJECT_SLOTS_API_H__
+
+// API for other mods to interact with the auto object slots mod.
+// Add "mm_recomp_auto_object_slots" to your mod's dependencies to use it.
+
+#include "modding.h"
+
+#define AUTO_OBJECT_SLOTS_MOD_ID "mm_recomp_auto_object_slots"
+
+// Registers objects that actors with the given ID depend on, so that they're part of the actor ID's slot set from the
+// start of every scene instead of being loaded the first time the actor looks them up.
+// Can be called at any point, including from a `recomp_on_init` callback.
+RECOMP_IMPORT(AUTO_OBJECT_SLOTS_MOD_ID, void AutoObjectSlots_registerActorObjects(s16 actorId, s16* objectIds, u32 count));
+
+// Resolves the given objects and adds them to the actor ID's slot set in a single call.
+// Only has an effect while a scene is running, so call it from a scene or actor init rather than `recomp_on_init`.
+// Returns the number of the given objects that are in the set afterwards.
+RECOMP_IMPORT(AUTO_OBJECT_SLOTS_MOD_ID, u32 AutoObjectSlots_resolveObjects(s16 actorId, s16* objectIds, u32 count));
+
+// Gives actors with the given ID a separate set for every distinct value of `params & mask`, for actor IDs whose variants
+// use different objects. A mask of zero goes back to a single set for the ID. Only affects sets loaded after the call.
+RECOMP_IMPORT(AUTO_OBJECT_SLOTS_MOD_ID, void AutoObjectSlots_setVariantMask(s16 actorId, u16 mask));
+
+// Adds objects to resolve ahead of time while the title screen and file select are running, so that the first gameplay
+// frames don't have to. Call it from a `recomp_on_init` callback.
+RECOMP_IMPORT(AUTO_OBJECT_SLOTS_MOD_ID, void AutoObjectSlots_addWarmupObjects(s16* objectIds, u32 count));
+
+// Limits the memory used by objects that this mod loads through its object cache, in bytes. When the limit is exceeded,
+// objects that no live actor's set holds and that haven't been used for a while are freed, least recently used first,
+// and loaded again when they're next looked up. Zero removes the limit.
+RECOMP_IMPORT(AUTO_OBJECT_SLOTS_MOD_ID, void AutoObjectSlots_setObjectMemoryBudget(u32 bytes));
+
+// Describes one actor for AutoObjectSlots_spawnActors. The fields are the arguments of Actor_SpawnAsChildAndCutscene.
+typedef struct {
+    /* 0x00 */ f32 x;
+    /* 0x04 */ f32 y;
+    /* 0x08 */ f32 z;
+    /* 0x0C */ s16 rotX;
+    /* 0x0E */ s16 rotY;
+    /* 0x10 */ s16 rotZ;
+    /* 0x12 */ s16 id;
+    /* 0x14 */ s32 params;
+    /* 0x18 */ u32 csId;
+    /* 0x1C */ u32 halfDaysBits;
+    /* 0x20 */ struct Actor* parent;
+} AutoObjectSlotsSpawnInfo; // size = 0x24
+
+// Spawns many actors at once. The actors are grouped by the slot set they use, and each group is spawned with its set
+// loaded once and its objects resolved up front, instead of switching sets for every actor. Actors of the same group
+// spawn in the order given, but groups may spawn in a different order. If `outActors` isn't NULL, it receives the
+// spawned actor (or NULL) for each entry of `spawns`. Returns the number of actors that were spawned.
+RECOMP_IMPORT(AUTO_OBJECT_SLOTS_MOD_ID, u32 AutoObjectSlots_spawnActors(struct PlayState* play, AutoObjectSlotsSpawnInfo* spawns,
+                                                                        u32 count, struct Actor** outActors));
+
+// Slot lifecycle events. Listen to them with
+// `RECOMP_CALLBACK(AUTO_OBJECT_SLOTS_MOD_ID, AutoObjectSlots_onObjectLoaded) void my_callback(s16 actorId, s16 objectId, s32 slot, void* segment)`.
+// `actorId` is the actor ID whose set changed, or AUTO_OBJECT_SLOTS_GLOBAL_SET for the global object context.
+// `slot` is the object context slot involved, or OBJECT_SLOT_NONE if the object isn't in a slot (e.g. it's in a set's
+// overflow entries). `segment` is the object's data.
+#define AUTO_OBJECT_SLOTS_GLOBAL_SET -1
+
+// Soft sprite effects have their own set per effect type, which is reported as this ID. It can also be passed as the
+// actor ID to the functions above to add objects to an effect type's set.
+#define AUTO_OBJECT_SLOTS_EFFECT_SET(type) (0x7F00 + (type))
+
+// An object was loaded into a set, either because it was looked up or because it was swapped back into a slot.
+//     void AutoObjectSlots_onObjectLoaded(s16 actorId, s16 objectId, s32 slot, void* segment)
+
+// An object was moved out of a slot to make room for another one. It stays part of the set and may be loaded again later.
+//     void AutoObjectSlots_onObjectEvicted(s16 actorId, s16 objectId, s32 slot, void* segment)
+
+// An object was dropped from a set, e.g. when the sets are reset for a new scene or a room replaces the previous room's
+// objects. Anything derived from the object's slot or segment for that set should be discarded.
+//     void AutoObjectSlots_onObjectInvalidated(s16 actorId, s16 objectId, s32 slot, void* segment)
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef __AUTO_OBJECT_SLOTS_NATIVE_H__
+#define __AUTO_OBJECT_SLOTS_NATIVE_H__
+
+// Interface between the auto object slots mod and the optional mod that ships its native library, see native_mod/.
+// The native library's mod hands its functions to the main mod when it's initialized, so that the main mod doesn't
+// depend on the native library and runs without the features that need it when it isn't installed.
+
+#include "modding.h"
+
+#define AUTO_OBJECT_SLOTS_NATIVE_MOD_ID "mm_recomp_auto_object_slots_native"
+
+// The native library's functions, see the files in native/ for what each of them does.
+typedef struct {
+    s32 (*objcacheOpen)(const char* savePath, u32 romHash);
+    s32 (*objcacheLookup)(s16 objectId, void* dst, u32 size);
+    s32 (*objcacheStore)(s16 objectId, const void* src, u32 size);
+    u32 (*yaz0BatchSubmit)(void* jobs, u32 count);
+    u32 (*yaz0BatchWait)(u32 batch);
+    u32 (*hostClockNs)(void);
+    s32 (*metricsOpen)(void);
+    void (*metricsPublish)(const u32* counters, u32 numCounters, const u32* sets, u32 numSets);
+} AutoObjectSlotsNativeFuncs;
+
+#endif
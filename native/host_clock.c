@@ -0,0 +1,12 @@
+// Host clock for timing code in the mod. The game's own timers run at the emulated CPU's count rate, which is too
+// coarse to time individual hooks.
+
+#include "lib_recomp.h"
+#include "platform.h"
+
+// u32 host_clock_ns(void)
+// Returns a monotonic host timestamp in nanoseconds. Only the low 32 bits are returned, so the value wraps every ~4.3
+// seconds and is only meant for measuring short intervals with unsigned subtraction.
+NATIVE_FUNC void host_clock_ns(uint8_t* rdram, recomp_context* ctx) {
+    native_return_u32(ctx, (uint32_t)native_clock_ns());
+}
@@ -0,0 +1,45 @@
+#ifndef __LIB_RECOMP_H__
+#define __LIB_RECOMP_H__
+
+// Helpers for native library functions called from the recompiled mod code.
+// Every exported function has the signature `void func(uint8_t* rdram, recomp_context* ctx)`, takes its arguments
+// from the MIPS argument registers and returns its result in v0.
+
+#include <string.h>
+
+#include "../offline_build/mod_recomp.h"
+
+#define NATIVE_FUNC RECOMP_EXPORT
+
+// Arguments are passed in a0-a3 (r4-r7).
+#define NATIVE_ARG_U32(ctx, index) ((uint32_t)(ctx)->r##index)
+#define NATIVE_ARG_S32(ctx, index) ((int32_t)(ctx)->r##index)
+
+// Converts a KSEG0 address from the mod into a host pointer in rdram.
+static inline void* native_to_ptr(uint8_t* rdram, uint32_t vaddr) {
+    return rdram + (vaddr - 0x80000000u);
+}
+
+static inline void native_return_s32(recomp_context* ctx, int32_t value) {
+    ctx->r2 = (gpr)value;
+}
+
+static inline void native_return_u32(recomp_context* ctx, uint32_t value) {
+    ctx->r2 = (gpr)(int32_t)value;
+}
+
+// rdram stores each 32-bit word in host order, so bytes have to be accessed with the address xor'd by 3.
+// Copies a zero-terminated string out of rdram into a host buffer, truncating it if needed.
+static inline void native_copy_string(uint8_t* rdram, uint32_t vaddr, char* out, size_t out_size) {
+    size_t i;
+    for (i = 0; i + 1 < out_size; i++) {
+        char c = (char)rdram[((vaddr + i) ^ 3) - 0x80000000u];
+        if (c == '\0') {
+            break;
+        }
+        out[i] = c;
+    }
+    out[i] = '\0';
+}
+
+#endif
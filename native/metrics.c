@@ -0,0 +1,62 @@
+// Publishes the mod's slot manager counters to a named shared memory region, so that an external process can follow
+// them without going through the game's logs or drawing anything in game. See tools/metrics_tail.c for a reader.
+
+#include "lib_recomp.h"
+#include "metrics_layout.h"
+#include "platform.h"
+
+static MetricsRegion* metrics_region = NULL;
+
+// s32 metrics_open(void)
+// Creates or opens the shared memory region. Returns 1 on success.
+NATIVE_FUNC void metrics_open(uint8_t* rdram, recomp_context* ctx) {
+    void* map;
+
+    if (metrics_region != NULL) {
+        native_return_s32(ctx, 1);
+        return;
+    }
+
+    map = native_shared_map(METRICS_SHM_NAME, sizeof(MetricsRegion), 1);
+    if (map == NULL) {
+        native_return_s32(ctx, 0);
+        return;
+    }
+
+    metrics_region = (MetricsRegion*)map;
+    memset(metrics_region, 0, sizeof(MetricsRegion));
+    metrics_region->magic = METRICS_MAGIC;
+    metrics_region->version = METRICS_VERSION;
+    native_return_s32(ctx, 1);
+}
+
+// void metrics_publish(const u32* counters, u32 num_counters, const MetricsSetSize* sets, u32 num_sets)
+// Copies the counters and set sizes into the region. Every field is a full word, so they're copied without swapping.
+NATIVE_FUNC void metrics_publish(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t num_counters = NATIVE_ARG_U32(ctx, 5);
+    uint32_t num_sets = NATIVE_ARG_U32(ctx, 7);
+    const uint32_t* counters = native_to_ptr(rdram, NATIVE_ARG_U32(ctx, 4));
+    const uint32_t* sets = native_to_ptr(rdram, NATIVE_ARG_U32(ctx, 6));
+
+    if (metrics_region == NULL) {
+        return;
+    }
+    if (num_counters > METRICS_NUM_COUNTERS) {
+        num_counters = METRICS_NUM_COUNTERS;
+    }
+    if (num_sets > METRICS_MAX_SETS) {
+        num_sets = METRICS_MAX_SETS;
+    }
+
+    __atomic_add_fetch(&metrics_region->sequence, 1, __ATOMIC_ACQ_REL);
+    memcpy(metrics_region->counters, counters, num_counters * sizeof(uint32_t));
+    // Set sizes come in as three words each: the ID, the entry counts packed as (shadow << 16) | entries, and the bytes.
+    for (uint32_t i = 0; i < num_sets; i++) {
+        metrics_region->sets[i].id = sets[i * 3];
+        metrics_region->sets[i].num_entries = (uint16_t)(sets[i * 3 + 1] & 0xFFFF);
+        metrics_region->sets[i].num_shadow_entries = (uint16_t)(sets[i * 3 + 1] >> 16);
+        metrics_region->sets[i].num_bytes = sets[i * 3 + 2];
+    }
+    metrics_region->num_sets = num_sets;
+    __atomic_add_fetch(&metrics_region->sequence, 1, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,54 @@
+#ifndef __METRICS_LAYOUT_H__
+#define __METRICS_LAYOUT_H__
+
+// Layout of the shared memory region that the mod's slot manager counters are published to every frame. Shared between
+// the native library (native/metrics.c) and the reader (tools/metrics_tail.c).
+
+#include <stdint.h>
+
+#define METRICS_SHM_NAME "/auto_object_slots_metrics"
+#define METRICS_MAGIC 0x414F534D // 'AOSM'
+#define METRICS_VERSION 3
+#define METRICS_MAX_SETS 1024
+
+// Counter indices. Everything except the stack depths and set counts is a running total, so readers look at deltas.
+// The order must match SlotMetrics in src/metrics.h.
+#define METRICS_COUNTERS(X)        \
+    X(FRAME, "frame")              \
+    X(SET_LOADS, "set_loads")      \
+    X(SET_LOADS_SKIPPED, "skipped") \
+    X(WINDOW_COPIES, "copies")     \
+    X(LOOKUP_HITS, "hits")         \
+    X(LOOKUP_MISSES, "misses")     \
+    X(AUTO_LOADS, "loads")         \
+    X(SHADOW_SWAPS, "swaps")       \
+    X(EVICTIONS, "evictions")      \
+    X(FROZEN_SKIPS, "frozen")      \
+    X(STACK_DEPTH, "depth")        \
+    X(MAX_STACK_DEPTH, "max_depth") \
+    X(NUM_SETS, "ids")             \
+    X(NUM_SHARED_SETS, "shared")
+
+#define METRICS_ENUM_ENTRY(name, str) METRIC_##name,
+enum { METRICS_COUNTERS(METRICS_ENUM_ENTRY) METRICS_NUM_COUNTERS };
+#undef METRICS_ENUM_ENTRY
+
+typedef struct {
+    uint32_t id;
+    uint16_t num_entries;
+    uint16_t num_shadow_entries;
+    // Total size of the objects in the set, in bytes.
+    uint32_t num_bytes;
+} MetricsSetSize;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    // Odd while the writer is updating the region. Readers retry if it's odd or changed while they were reading.
+    uint32_t sequence;
+    uint32_t num_sets;
+    uint32_t counters[METRICS_NUM_COUNTERS];
+    MetricsSetSize sets[METRICS_MAX_SETS];
+} MetricsRegion;
+
+#endif
@@ -0,0 +1,6 @@
+// Entry point data for the auto object slots native library.
+
+#include "lib_recomp.h"
+
+// Version of the native library API this library targets, checked by the runtime when loading it.
+RECOMP_EXPORT uint32_t recomp_api_version = 1;
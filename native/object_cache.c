@@ -0,0 +1,212 @@
+// On-disk cache of decompressed object files.
+//
+// The cache is a single append-only file next to the save file. It starts with a header holding the ROM hash it was
+// built for, followed by one record per stored object. On open, the file is mapped read-only (see native/platform.h)
+// and the records that are already in it are indexed by object ID, so that lookups are a single copy out of the
+// mapping and the file's contents are only paged in as objects are looked up. Objects stored during this session are
+// appended to the file with standard C file IO and become visible the next time the cache is opened.
+//
+// Object data is copied exactly as it is laid out in rdram, so blobs are only ever written back into rdram and never
+// interpreted on the host.
+
+#include <stdio.h>
+
+#include "lib_recomp.h"
+#include "platform.h"
+
+#define OBJCACHE_MAGIC 0x414F5343 // 'AOSC'
+#define OBJCACHE_RECORD_MAGIC 0x4F424A52 // 'OBJR'
+#define OBJCACHE_VERSION 2
+#define OBJCACHE_FILENAME "auto_object_slots_cache.bin"
+#define OBJCACHE_MAX_IDS 0x10000
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t rom_hash;
+    uint32_t pad;
+} ObjCacheHeader;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t object_id;
+    uint32_t size;
+    uint32_t pad;
+} ObjCacheRecord;
+
+typedef struct {
+    // Offset of the object's data in the mapping, or 0 if the object wasn't in the file when it was opened.
+    uint32_t offset;
+    uint32_t size;
+} ObjCacheIndexEntry;
+
+static FILE* cache_file = NULL;
+static const uint8_t* cache_map = NULL;
+static size_t cache_map_size = 0;
+static long cache_file_end = 0;
+static ObjCacheIndexEntry cache_index[OBJCACHE_MAX_IDS];
+
+static int objcache_build_path(const char* save_path, char* out, size_t out_size) {
+    const char* slash = strrchr(save_path, '/');
+    const char* backslash = strrchr(save_path, '\\');
+    size_t dir_len;
+
+    if (backslash != NULL && (slash == NULL || backslash > slash)) {
+        slash = backslash;
+    }
+    dir_len = slash != NULL ? (size_t)(slash - save_path) + 1 : 0;
+
+    if (dir_len + sizeof(OBJCACHE_FILENAME) > out_size) {
+        return 0;
+    }
+    memcpy(out, save_path, dir_len);
+    memcpy(out + dir_len, OBJCACHE_FILENAME, sizeof(OBJCACHE_FILENAME));
+    return 1;
+}
+
+// Writes a zeroed record at the current file position. Standard C can't shrink a file, so this marks the end of the
+// valid records and keeps stale ones past it (e.g. from before a reset) from being indexed.
+static int objcache_write_terminator(void) {
+    ObjCacheRecord terminator = { 0 };
+
+    return fwrite(&terminator, sizeof(terminator), 1, cache_file) == 1 && fflush(cache_file) == 0;
+}
+
+static int objcache_reset_file(uint32_t rom_hash) {
+    ObjCacheHeader header = { OBJCACHE_MAGIC, OBJCACHE_VERSION, rom_hash, 0 };
+
+    if (fseek(cache_file, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, cache_file) != 1 ||
+        !objcache_write_terminator()) {
+        return 0;
+    }
+    cache_file_end = sizeof(header);
+    return 1;
+}
+
+// Walks the records in the mapping and indexes them. The terminator or a truncated trailing record (e.g. from
+// a crash mid-write) ends the scan and is overwritten by the next store.
+static void objcache_index_mapping(void) {
+    size_t offset = sizeof(ObjCacheHeader);
+
+    while (offset + sizeof(ObjCacheRecord) <= cache_map_size) {
+        const ObjCacheRecord* record = (const ObjCacheRecord*)(cache_map + offset);
+        size_t data_offset = offset + sizeof(ObjCacheRecord);
+
+        if (record->magic != OBJCACHE_RECORD_MAGIC || record->object_id >= OBJCACHE_MAX_IDS ||
+            record->size > cache_map_size - data_offset) {
+            break;
+        }
+        cache_index[record->object_id].offset = (uint32_t)data_offset;
+        cache_index[record->object_id].size = record->size;
+        offset = data_offset + record->size;
+    }
+
+    cache_file_end = (long)offset;
+}
+
+static void objcache_close(void) {
+    if (cache_map != NULL) {
+        native_file_unmap(cache_map, cache_map_size);
+        cache_map = NULL;
+        cache_map_size = 0;
+    }
+    if (cache_file != NULL) {
+        fclose(cache_file);
+        cache_file = NULL;
+    }
+    memset(cache_index, 0, sizeof(cache_index));
+    cache_file_end = 0;
+}
+
+// s32 objcache_open(const char* save_path, u32 rom_hash)
+// Opens (or creates) the cache file in the save file's folder. Returns 1 on success.
+NATIVE_FUNC void objcache_open(uint8_t* rdram, recomp_context* ctx) {
+    char save_path[1024];
+    char cache_path[1024];
+    uint32_t rom_hash = NATIVE_ARG_U32(ctx, 5);
+    ObjCacheHeader header;
+    long file_size;
+
+    objcache_close();
+    native_copy_string(rdram, NATIVE_ARG_U32(ctx, 4), save_path, sizeof(save_path));
+
+    if (!objcache_build_path(save_path, cache_path, sizeof(cache_path))) {
+        native_return_s32(ctx, 0);
+        return;
+    }
+
+    // "r+b" doesn't create the file and "w+b" truncates it, so create it separately if it doesn't exist yet.
+    cache_file = fopen(cache_path, "r+b");
+    if (cache_file == NULL) {
+        cache_file = fopen(cache_path, "w+b");
+    }
+    if (cache_file == NULL || fseek(cache_file, 0, SEEK_END) != 0 || (file_size = ftell(cache_file)) < 0 ||
+        fseek(cache_file, 0, SEEK_SET) != 0) {
+        objcache_close();
+        native_return_s32(ctx, 0);
+        return;
+    }
+
+    // Discard the file if it was built for a different ROM or cache version.
+    if ((size_t)file_size < sizeof(header) || fread(&header, sizeof(header), 1, cache_file) != 1 ||
+        header.magic != OBJCACHE_MAGIC || header.version != OBJCACHE_VERSION || header.rom_hash != rom_hash) {
+        if (!objcache_reset_file(rom_hash)) {
+            objcache_close();
+            native_return_s32(ctx, 0);
+            return;
+        }
+        native_return_s32(ctx, 1);
+        return;
+    }
+
+    cache_map = native_file_map(cache_file, (size_t)file_size);
+    if (cache_map == NULL) {
+        // Start over rather than appending past records that couldn't be indexed.
+        native_return_s32(ctx, objcache_reset_file(rom_hash));
+        return;
+    }
+
+    cache_map_size = (size_t)file_size;
+    objcache_index_mapping();
+    native_return_s32(ctx, 1);
+}
+
+// s32 objcache_lookup(s16 object_id, void* dst, u32 size)
+// Copies a cached object into dst. Returns 1 if the object was found with the expected size.
+NATIVE_FUNC void objcache_lookup(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t object_id = NATIVE_ARG_U32(ctx, 4) & 0xFFFF;
+    uint32_t dst = NATIVE_ARG_U32(ctx, 5);
+    uint32_t size = NATIVE_ARG_U32(ctx, 6);
+    const ObjCacheIndexEntry* entry = &cache_index[object_id];
+
+    if (cache_map == NULL || entry->offset == 0 || entry->size != size || (dst & 3) != 0) {
+        native_return_s32(ctx, 0);
+        return;
+    }
+
+    memcpy(native_to_ptr(rdram, dst), cache_map + entry->offset, size);
+    native_return_s32(ctx, 1);
+}
+
+// s32 objcache_store(s16 object_id, const void* src, u32 size)
+// Appends an object to the cache file. Returns 1 on success.
+NATIVE_FUNC void objcache_store(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t object_id = NATIVE_ARG_U32(ctx, 4) & 0xFFFF;
+    uint32_t src = NATIVE_ARG_U32(ctx, 5);
+    uint32_t size = NATIVE_ARG_U32(ctx, 6);
+    ObjCacheRecord record = { OBJCACHE_RECORD_MAGIC, object_id, size, 0 };
+
+    if (cache_file == NULL || (src & 3) != 0 || (size & 3) != 0) {
+        native_return_s32(ctx, 0);
+        return;
+    }
+
+    if (fseek(cache_file, cache_file_end, SEEK_SET) != 0 || fwrite(&record, sizeof(record), 1, cache_file) != 1 ||
+        fwrite(native_to_ptr(rdram, src), 1, size, cache_file) != size || !objcache_write_terminator()) {
+        native_return_s32(ctx, 0);
+        return;
+    }
+
+    cache_file_end += (long)(sizeof(record) + size);
+    native_return_s32(ctx, 1);
+}
@@ -0,0 +1,225 @@
+#ifndef __NATIVE_PLATFORM_H__
+#define __NATIVE_PLATFORM_H__
+
+// Thin layer over the few OS facilities the native library and host tools use, so that they build for Windows as well
+// as for POSIX systems: a mutex and condition variables, detached threads, a monotonic clock, named shared memory and
+// read-only file mappings.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+
+#define WIN32_LEAN_AND_MEAN
+#include <io.h>
+#include <windows.h>
+
+typedef SRWLOCK native_mutex_t;
+typedef CONDITION_VARIABLE native_cond_t;
+
+#define NATIVE_MUTEX_INITIALIZER SRWLOCK_INIT
+#define NATIVE_COND_INITIALIZER CONDITION_VARIABLE_INIT
+
+static inline void native_mutex_lock(native_mutex_t* mutex) {
+    AcquireSRWLockExclusive(mutex);
+}
+
+static inline void native_mutex_unlock(native_mutex_t* mutex) {
+    ReleaseSRWLockExclusive(mutex);
+}
+
+static inline void native_cond_wait(native_cond_t* cond, native_mutex_t* mutex) {
+    SleepConditionVariableSRW(cond, mutex, INFINITE, 0);
+}
+
+static inline void native_cond_broadcast(native_cond_t* cond) {
+    WakeAllConditionVariable(cond);
+}
+
+typedef struct {
+    void* (*func)(void*);
+    void* arg;
+} NativeThreadStart;
+
+static DWORD WINAPI native_thread_entry(LPVOID param) {
+    NativeThreadStart start = *(NativeThreadStart*)param;
+    HeapFree(GetProcessHeap(), 0, param);
+    start.func(start.arg);
+    return 0;
+}
+
+// Starts a detached thread. Returns 1 on success.
+static inline int native_thread_start(void* (*func)(void*), void* arg) {
+    NativeThreadStart* start = HeapAlloc(GetProcessHeap(), 0, sizeof(NativeThreadStart));
+    HANDLE thread;
+
+    if (start == NULL) {
+        return 0;
+    }
+    start->func = func;
+    start->arg = arg;
+    thread = CreateThread(NULL, 0, native_thread_entry, start, 0, NULL);
+    if (thread == NULL) {
+        HeapFree(GetProcessHeap(), 0, start);
+        return 0;
+    }
+    CloseHandle(thread);
+    return 1;
+}
+
+static inline long native_num_cores(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (long)info.dwNumberOfProcessors;
+}
+
+static inline uint64_t native_clock_ns(void) {
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000ull +
+           (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000ull / (uint64_t)frequency.QuadPart;
+}
+
+static inline void native_sleep_ms(int ms) {
+    Sleep((DWORD)ms);
+}
+
+// Maps the named shared memory region, creating it if `create` is set. Returns NULL on failure. The name is a POSIX
+// style "/name", which is turned into a session-local mapping name.
+static inline void* native_shared_map(const char* name, size_t size, int create) {
+    char mapping_name[256];
+    HANDLE mapping;
+    void* map;
+
+    snprintf(mapping_name, sizeof(mapping_name), "Local\\%s", name[0] == '/' ? name + 1 : name);
+    if (create) {
+        mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD)size, mapping_name);
+    } else {
+        mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, mapping_name);
+    }
+    if (mapping == NULL) {
+        return NULL;
+    }
+    // The mapping stays alive as long as a view of it exists.
+    map = MapViewOfFile(mapping, create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, size);
+    CloseHandle(mapping);
+    return map;
+}
+
+// Maps the first `size` bytes of an open file read-only. Returns NULL on failure. The file can still be written through
+// `file` while it's mapped, and anything appended past `size` isn't part of the mapping.
+static inline const void* native_file_map(FILE* file, size_t size) {
+    HANDLE handle = (HANDLE)_get_osfhandle(_fileno(file));
+    HANDLE mapping;
+    const void* map;
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+    mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        return NULL;
+    }
+    map = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    CloseHandle(mapping);
+    return map;
+}
+
+static inline void native_file_unmap(const void* map, size_t size) {
+    UnmapViewOfFile(map);
+}
+
+#else
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef pthread_mutex_t native_mutex_t;
+typedef pthread_cond_t native_cond_t;
+
+#define NATIVE_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+#define NATIVE_COND_INITIALIZER PTHREAD_COND_INITIALIZER
+
+static inline void native_mutex_lock(native_mutex_t* mutex) {
+    pthread_mutex_lock(mutex);
+}
+
+static inline void native_mutex_unlock(native_mutex_t* mutex) {
+    pthread_mutex_unlock(mutex);
+}
+
+static inline void native_cond_wait(native_cond_t* cond, native_mutex_t* mutex) {
+    pthread_cond_wait(cond, mutex);
+}
+
+static inline void native_cond_broadcast(native_cond_t* cond) {
+    pthread_cond_broadcast(cond);
+}
+
+// Starts a detached thread. Returns 1 on success.
+static inline int native_thread_start(void* (*func)(void*), void* arg) {
+    pthread_t thread;
+
+    if (pthread_create(&thread, NULL, func, arg) != 0) {
+        return 0;
+    }
+    pthread_detach(thread);
+    return 1;
+}
+
+static inline long native_num_cores(void) {
+    return sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+static inline uint64_t native_clock_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline void native_sleep_ms(int ms) {
+    struct timespec delay = { ms / 1000, (ms % 1000) * 1000000L };
+    nanosleep(&delay, NULL);
+}
+
+// Maps the named shared memory region, creating it if `create` is set. Returns NULL on failure.
+static inline void* native_shared_map(const char* name, size_t size, int create) {
+    int fd = shm_open(name, create ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    void* map;
+
+    if (fd == -1) {
+        return NULL;
+    }
+    if (create && ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        return NULL;
+    }
+    map = mmap(NULL, size, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    return map == MAP_FAILED ? NULL : map;
+}
+
+// Maps the first `size` bytes of an open file read-only. Returns NULL on failure. The file can still be written through
+// `file` while it's mapped, and anything appended past `size` isn't part of the mapping.
+static inline const void* native_file_map(FILE* file, size_t size) {
+    void* map = mmap(NULL, size, PROT_READ, MAP_SHARED, fileno(file), 0);
+    return map == MAP_FAILED ? NULL : map;
+}
+
+static inline void native_file_unmap(const void* map, size_t size) {
+    munmap((void*)map, size);
+}
+
+#endif
+
+#endif
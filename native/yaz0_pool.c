@@ -0,0 +1,248 @@
+// Worker pool that decompresses batches of Yaz0 files concurrently.
+//
+// The mod submits an array of jobs, each pointing to a compressed file and a destination buffer in rdram, and gets
+// back a batch handle. The pool's workers decompress the jobs in the background while the game thread continues, and
+// the game thread helps finish the remaining jobs when it waits on the batch.
+
+#include "lib_recomp.h"
+#include "platform.h"
+
+#define YAZ0_MAX_WORKERS 16
+#define YAZ0_MAX_BATCHES 8
+#define YAZ0_MAX_JOBS 256
+
+// Layout of a job in rdram. Every field is a full word, so fields can be read without byte swapping.
+typedef struct {
+    uint32_t src;
+    uint32_t src_size;
+    uint32_t dst;
+    uint32_t dst_size;
+    int32_t status;
+} Yaz0Job;
+
+typedef struct {
+    int in_use;
+    uint8_t* rdram;
+    uint32_t jobs_vaddr;
+    uint32_t count;
+    uint32_t next;
+    uint32_t remaining;
+    Yaz0Job jobs[YAZ0_MAX_JOBS];
+} Yaz0Batch;
+
+static native_mutex_t pool_mutex = NATIVE_MUTEX_INITIALIZER;
+static native_cond_t pool_work_cond = NATIVE_COND_INITIALIZER;
+static native_cond_t pool_done_cond = NATIVE_COND_INITIALIZER;
+static int pool_started = 0;
+static Yaz0Batch pool_batches[YAZ0_MAX_BATCHES];
+
+// Bytes in rdram are stored with the address xor'd by 3, see lib_recomp.h.
+#define RDRAM_BYTE(rdram, vaddr) ((rdram)[((vaddr) ^ 3) - 0x80000000u])
+
+static int32_t yaz0_decompress(uint8_t* rdram, const Yaz0Job* job) {
+    uint32_t src = job->src;
+    uint32_t dst = job->dst;
+    uint32_t in = 0x10;
+    uint32_t out = 0;
+    uint32_t out_size;
+    uint32_t group = 0;
+    int bits = 0;
+
+    if (job->src_size < 0x10 || RDRAM_BYTE(rdram, src + 0) != 'Y' || RDRAM_BYTE(rdram, src + 1) != 'a' ||
+        RDRAM_BYTE(rdram, src + 2) != 'z' || RDRAM_BYTE(rdram, src + 3) != '0') {
+        return 0;
+    }
+
+    out_size = ((uint32_t)RDRAM_BYTE(rdram, src + 4) << 24) | ((uint32_t)RDRAM_BYTE(rdram, src + 5) << 16) |
+               ((uint32_t)RDRAM_BYTE(rdram, src + 6) << 8) | (uint32_t)RDRAM_BYTE(rdram, src + 7);
+    if (out_size > job->dst_size) {
+        return 0;
+    }
+
+    while (out < out_size) {
+        if (bits == 0) {
+            if (in >= job->src_size) {
+                return 0;
+            }
+            group = RDRAM_BYTE(rdram, src + in++);
+            bits = 8;
+        }
+
+        if (group & 0x80) {
+            if (in >= job->src_size) {
+                return 0;
+            }
+            RDRAM_BYTE(rdram, dst + out++) = RDRAM_BYTE(rdram, src + in++);
+        } else {
+            uint32_t b1;
+            uint32_t b2;
+            uint32_t dist;
+            uint32_t length;
+
+            if (in + 2 > job->src_size) {
+                return 0;
+            }
+            b1 = RDRAM_BYTE(rdram, src + in++);
+            b2 = RDRAM_BYTE(rdram, src + in++);
+            dist = (((b1 & 0xF) << 8) | b2) + 1;
+            length = b1 >> 4;
+            if (length == 0) {
+                if (in >= job->src_size) {
+                    return 0;
+                }
+                length = RDRAM_BYTE(rdram, src + in++) + 0x12;
+            } else {
+                length += 2;
+            }
+
+            if (dist > out || length > out_size - out) {
+                return 0;
+            }
+            while (length-- > 0) {
+                RDRAM_BYTE(rdram, dst + out) = RDRAM_BYTE(rdram, dst + out - dist);
+                out++;
+            }
+        }
+
+        group <<= 1;
+        bits--;
+    }
+
+    return 1;
+}
+
+// Claims the next unstarted job of any batch. Must be called with the pool mutex held.
+static int yaz0_claim_job(Yaz0Batch** out_batch, uint32_t* out_index) {
+    for (int i = 0; i < YAZ0_MAX_BATCHES; i++) {
+        Yaz0Batch* batch = &pool_batches[i];
+        if (batch->in_use && batch->next < batch->count) {
+            *out_batch = batch;
+            *out_index = batch->next++;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Runs a claimed job. Must be called with the pool mutex held, which is released while decompressing.
+static void yaz0_run_job(Yaz0Batch* batch, uint32_t index) {
+    Yaz0Job* job = &batch->jobs[index];
+
+    native_mutex_unlock(&pool_mutex);
+    job->status = yaz0_decompress(batch->rdram, job);
+    native_mutex_lock(&pool_mutex);
+
+    batch->remaining--;
+    if (batch->remaining == 0) {
+        native_cond_broadcast(&pool_done_cond);
+    }
+}
+
+static void* yaz0_worker(void* arg) {
+    Yaz0Batch* batch;
+    uint32_t index;
+
+    native_mutex_lock(&pool_mutex);
+    while (1) {
+        if (yaz0_claim_job(&batch, &index)) {
+            yaz0_run_job(batch, index);
+        } else {
+            native_cond_wait(&pool_work_cond, &pool_mutex);
+        }
+    }
+    return NULL;
+}
+
+// Starts one worker per host core beyond the game thread. Must be called with the pool mutex held.
+static void yaz0_start_pool(void) {
+    long num_cores = native_num_cores();
+    long num_workers = num_cores > 1 ? num_cores - 1 : 1;
+
+    if (num_workers > YAZ0_MAX_WORKERS) {
+        num_workers = YAZ0_MAX_WORKERS;
+    }
+
+    for (long i = 0; i < num_workers; i++) {
+        native_thread_start(yaz0_worker, NULL);
+    }
+    pool_started = 1;
+}
+
+// u32 yaz0_batch_submit(Yaz0Job* jobs, u32 count)
+// Queues a batch of jobs. Returns a nonzero batch handle, or 0 if the batch couldn't be queued.
+// The source and destination buffers must not be touched until the batch has been waited on.
+NATIVE_FUNC void yaz0_batch_submit(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t jobs_vaddr = NATIVE_ARG_U32(ctx, 4);
+    uint32_t count = NATIVE_ARG_U32(ctx, 5);
+    uint32_t handle = 0;
+
+    if (count == 0 || count > YAZ0_MAX_JOBS || (jobs_vaddr & 3) != 0) {
+        native_return_u32(ctx, 0);
+        return;
+    }
+
+    native_mutex_lock(&pool_mutex);
+    if (!pool_started) {
+        yaz0_start_pool();
+    }
+
+    for (int i = 0; i < YAZ0_MAX_BATCHES; i++) {
+        Yaz0Batch* batch = &pool_batches[i];
+        if (!batch->in_use) {
+            batch->in_use = 1;
+            batch->rdram = rdram;
+            batch->jobs_vaddr = jobs_vaddr;
+            batch->count = count;
+            batch->next = 0;
+            batch->remaining = count;
+            memcpy(batch->jobs, native_to_ptr(rdram, jobs_vaddr), count * sizeof(Yaz0Job));
+            handle = (uint32_t)i + 1;
+            native_cond_broadcast(&pool_work_cond);
+            break;
+        }
+    }
+    native_mutex_unlock(&pool_mutex);
+
+    native_return_u32(ctx, handle);
+}
+
+// u32 yaz0_batch_wait(u32 handle)
+// Blocks until every job in the batch is done, writes each job's status back and releases the batch.
+// Returns the number of jobs that decompressed successfully.
+NATIVE_FUNC void yaz0_batch_wait(uint8_t* rdram, recomp_context* ctx) {
+    uint32_t handle = NATIVE_ARG_U32(ctx, 4);
+    uint32_t num_succeeded = 0;
+    Yaz0Batch* batch;
+    Yaz0Job* out_jobs;
+
+    if (handle == 0 || handle > YAZ0_MAX_BATCHES) {
+        native_return_u32(ctx, 0);
+        return;
+    }
+    batch = &pool_batches[handle - 1];
+
+    native_mutex_lock(&pool_mutex);
+    if (!batch->in_use) {
+        native_mutex_unlock(&pool_mutex);
+        native_return_u32(ctx, 0);
+        return;
+    }
+
+    // Help with this batch's remaining jobs instead of idling, then wait for the ones still running on workers.
+    while (batch->next < batch->count) {
+        yaz0_run_job(batch, batch->next++);
+    }
+    while (batch->remaining > 0) {
+        native_cond_wait(&pool_done_cond, &pool_mutex);
+    }
+
+    out_jobs = (Yaz0Job*)native_to_ptr(rdram, batch->jobs_vaddr);
+    for (uint32_t i = 0; i < batch->count; i++) {
+        out_jobs[i].status = batch->jobs[i].status;
+        num_succeeded += batch->jobs[i].status != 0;
+    }
+    batch->in_use = 0;
+    native_mutex_unlock(&pool_mutex);
+
+    native_return_u32(ctx, num_succeeded);
+}
@@ -0,0 +1,66 @@
+#include "modding.h"
+#include "global.h"
+
+#include "auto_object_slots_api.h"
+#include "auto_object_slots_native.h"
+
+// This mod only ships the auto object slots mod's native library (built from native/) and hands its functions to that
+// mod. Imports can't have their address taken, so each function gets a wrapper that the table points to instead.
+
+RECOMP_IMPORT(".", s32 objcache_open(const char* save_path, u32 rom_hash));
+RECOMP_IMPORT(".", s32 objcache_lookup(s16 object_id, void* dst, u32 size));
+RECOMP_IMPORT(".", s32 objcache_store(s16 object_id, const void* src, u32 size));
+RECOMP_IMPORT(".", u32 yaz0_batch_submit(void* jobs, u32 count));
+RECOMP_IMPORT(".", u32 yaz0_batch_wait(u32 batch));
+RECOMP_IMPORT(".", u32 host_clock_ns(void));
+RECOMP_IMPORT(".", s32 metrics_open(void));
+RECOMP_IMPORT(".", void metrics_publish(const u32* counters, u32 num_counters, const u32* sets, u32 num_sets));
+
+RECOMP_IMPORT(AUTO_OBJECT_SLOTS_MOD_ID, void AutoObjectSlots_registerNative(const AutoObjectSlotsNativeFuncs* funcs));
+
+s32 native_objcache_open(const char* save_path, u32 rom_hash) {
+    return objcache_open(save_path, rom_hash);
+}
+
+s32 native_objcache_lookup(s16 object_id, void* dst, u32 size) {
+    return objcache_lookup(object_id, dst, size);
+}
+
+s32 native_objcache_store(s16 object_id, const void* src, u32 size) {
+    return objcache_store(object_id, src, size);
+}
+
+u32 native_yaz0_batch_submit(void* jobs, u32 count) {
+    return yaz0_batch_submit(jobs, count);
+}
+
+u32 native_yaz0_batch_wait(u32 batch) {
+    return yaz0_batch_wait(batch);
+}
+
+u32 native_host_clock_ns(void) {
+    return host_clock_ns();
+}
+
+s32 native_metrics_open(void) {
+    return metrics_open();
+}
+
+void native_metrics_publish(const u32* counters, u32 num_counters, const u32* sets, u32 num_sets) {
+    metrics_publish(counters, num_counters, sets, num_sets);
+}
+
+const AutoObjectSlotsNativeFuncs native_funcs = {
+    native_objcache_open,
+    native_objcache_lookup,
+    native_objcache_store,
+    native_yaz0_batch_submit,
+    native_yaz0_batch_wait,
+    native_host_clock_ns,
+    native_metrics_open,
+    native_metrics_publish,
+};
+
+RECOMP_CALLBACK("*", recomp_on_init) void native_mod_on_init() {
+    AutoObjectSlots_registerNative(&native_funcs);
+}
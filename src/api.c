@@ -0,0 +1,132 @@
+#include "modding.h"
+#include "global.h"
+#include "recomputils.h"
+
+#include "auto_slots.h"
+#include "slot_config.h"
+
+// Objects that other mods have registered as dependencies of an actor ID. These get added to the actor ID's set every
+// time the sets are reset for a new scene, so the actors never have to discover them through a lookup miss.
+typedef struct {
+    s16 actorId;
+    s16 objectId;
+} RegisteredObject;
+
+RegisteredObject* registered_objects = NULL;
+u32 num_registered_objects = 0;
+u32 registered_objects_capacity = 0;
+
+bool add_registered_object(s16 actorId, s16 objectId) {
+    for (u32 i = 0; i < num_registered_objects; i++) {
+        if (registered_objects[i].actorId == actorId && registered_objects[i].objectId == objectId) {
+            return false;
+        }
+    }
+
+    if (num_registered_objects == registered_objects_capacity) {
+        u32 new_capacity = registered_objects_capacity == 0 ? 64 : registered_objects_capacity * 2;
+        RegisteredObject* new_objects = recomp_alloc(new_capacity * sizeof(RegisteredObject));
+        for (u32 i = 0; i < num_registered_objects; i++) {
+            new_objects[i] = registered_objects[i];
+        }
+        if (registered_objects != NULL) {
+            recomp_free(registered_objects);
+        }
+        registered_objects = new_objects;
+        registered_objects_capacity = new_capacity;
+    }
+
+    registered_objects[num_registered_objects].actorId = actorId;
+    registered_objects[num_registered_objects].objectId = objectId;
+    num_registered_objects++;
+    return true;
+}
+
+u32 get_num_registered_objects(void) {
+    return num_registered_objects;
+}
+
+s16 get_registered_object_id(u32 index) {
+    return registered_objects[index].objectId;
+}
+
+void apply_registered_actor_objects(void) {
+    for (u32 i = 0; i < num_registered_objects; i++) {
+        if (!id_slots_add_object(registered_objects[i].actorId, registered_objects[i].objectId)) {
+            SLOT_LOG(SLOT_LOG_WARNINGS, "Warning: No room for registered object %s in the set for %s\n",
+                     get_obj_define_string(registered_objects[i].objectId),
+                     get_actor_define_string(registered_objects[i].actorId));
+        }
+    }
+}
+
+void apply_registered_variant_objects(SlotSetId id) {
+    s16 actorId = SLOT_SET_ACTOR_ID(id);
+
+    for (u32 i = 0; i < num_registered_objects; i++) {
+        if (registered_objects[i].actorId == actorId) {
+            id_slots_add_object(id, registered_objects[i].objectId);
+        }
+    }
+}
+
+// Object IDs from other mods are checked before they get anywhere near a set, since a set entry is used as an index into
+// the object table. Returns false and logs the ID if it isn't a vanilla object ID.
+bool is_valid_api_object_id(const char* func, s16 actorId, s16 objectId) {
+    if (objectId > 0 && objectId < OBJECT_ID_MAX) {
+        return true;
+    }
+    SLOT_LOG(SLOT_LOG_WARNINGS, "Warning: %s: Ignoring invalid object ID 0x%04X for actor ID 0x%04X\n", func, objectId,
+             actorId);
+    return false;
+}
+
+// Registers objects that actors with the given ID depend on. They're added to the actor ID's set whenever a scene starts,
+// as well as immediately if a scene is already running. Safe to call from `recomp_on_init`.
+RECOMP_EXPORT void AutoObjectSlots_registerActorObjects(s16 actorId, s16* objectIds, u32 count) {
+    for (u32 i = 0; i < count; i++) {
+        if (!is_valid_api_object_id("AutoObjectSlots_registerActorObjects", actorId, objectIds[i])) {
+            continue;
+        }
+        if (add_registered_object(actorId, objectIds[i]) && slot_sets_initialized) {
+            id_slots_add_object(actorId, objectIds[i]);
+        }
+    }
+}
+
+// Resolves the given objects and adds them to the actor ID's set in one go.
+// Only has an effect while a scene is running, e.g. from a scene or actor init. Returns the number of objects that are
+// in the set afterwards.
+RECOMP_EXPORT u32 AutoObjectSlots_resolveObjects(s16 actorId, s16* objectIds, u32 count) {
+    s16* valid_ids;
+    u32 num_valid = 0;
+    u32 num_in_set;
+
+    if (!slot_sets_initialized) {
+        return 0;
+    }
+
+    for (u32 i = 0; i < count; i++) {
+        if (is_valid_api_object_id("AutoObjectSlots_resolveObjects", actorId, objectIds[i])) {
+            num_valid++;
+        }
+    }
+    if (num_valid == count) {
+        return id_slots_add_objects(actorId, objectIds, count);
+    }
+    if (num_valid == 0) {
+        return 0;
+    }
+
+    // Only the valid IDs are added, still in a single call so that the set is only copied once.
+    valid_ids = recomp_alloc(num_valid * sizeof(s16));
+    num_valid = 0;
+    for (u32 i = 0; i < count; i++) {
+        if (objectIds[i] > 0 && objectIds[i] < OBJECT_ID_MAX) {
+            valid_ids[num_valid++] = objectIds[i];
+        }
+    }
+    num_in_set = id_slots_add_objects(actorId, valid_ids, num_valid);
+    recomp_free(valid_ids);
+    return num_in_set;
+}
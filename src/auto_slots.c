@@ -1,18 +1,17 @@
 #include "modding.h"
 #include "global.h"
 #include "recomputils.h"
+#include "recompdata.h"
 
 #include "globalobjects_api.h"
-
-// Must not be changed, needs to match the size of ObjectContext's slots array.
-#define OBJECT_SLOT_COUNT 35
-
-typedef struct {
-    u8 numEntries;
-    // numPersistentEntries is inherited from the global object context.
-    s16 ids[OBJECT_SLOT_COUNT];
-    void* objects[OBJECT_SLOT_COUNT];
-} IdSlots;
+#include "object_cache.h"
+#include "auto_slots.h"
+#include "profiler.h"
+#include "metrics.h"
+#include "pollution.h"
+#include "slot_verify.h"
+#include "shared_prefix.h"
+#include "slot_config.h"
 
 typedef struct {
     u8 numEntries;
@@ -20,15 +19,52 @@ typedef struct {
     u8 mainKeepSlot;
     u8 subKeepSlot;
     s16 ids[OBJECT_SLOT_COUNT];
-    void* objects[OBJECT_SLOT_COUNT];
-    DmaRequest dmaReqs[OBJECT_SLOT_COUNT];
+    // The segment of the first unused slot, which is where the next persistent object would be loaded to.
+    void* freeSegment;
 } GlobalSlots;
 
-IdSlots all_id_slots[ACTOR_ID_MAX];
+// Per-ID sets are looked up through a hashmap keyed by actor ID, so actor IDs added by other mods get their own sets
+// just like vanilla ones. Every ID that has been seen is also kept in a list so they can all be reset when a new scene
+// starts.
+U32ValueHashmapHandle id_slots_map;
+SlotSetId* known_set_ids = NULL;
+u32 num_known_set_ids = 0;
+u32 known_set_ids_capacity = 0;
+
+// Many IDs end up with identical sets, e.g. just the persistent objects plus the same one or two objects of their own.
+// Identical sets are shared between IDs by registering each set under a hash of its contents, and a shared set is
+// copied before it gets modified for one of its IDs (see detach_id_slots). Switching between two IDs that share a set
+// then doesn't need to touch the object context at all.
+U32ValueHashmapHandle shared_slots_map;
+
+// Whether the object context's window has been modified since the loaded per-ID set was copied into it. Only the mod's
+// own object loading modifies the window while a per-ID set is loaded, so a clean window doesn't need to be written
+// back into its set.
+bool loaded_slots_dirty = false;
+
+// The persistent objects that every set starts with, copied from the global object context.
+IdSlots persistent_slots;
+
 GlobalSlots global_slots;
 
+bool slot_sets_initialized = false;
+
+// Changes whenever an ID is bound to a different set or a set's contents change, see object_cache_enforce_budget.
+u32 slot_sets_generation = 0;
+
+// The scene the per-ID sets currently belong to, and whether any set has been used since they were last reset. The
+// persistent objects are spawned one at a time when a scene starts, so only the first reset after the sets were used
+// has anything worth retaining.
+s16 slot_sets_scene_id = -1;
+bool slot_sets_in_use = false;
+
 bool auto_slot_loading_enabled = false;
 
+bool batch_spawn_pending = false;
+
+// Opt-in, since anything that reads a slot's segment without looking the object up first would see NULL.
+bool lazy_scene_objects_enabled = false;
+
 // Tracks how many layers of recursive slot loading are active. This is needed because actors can spawn other actors,
 // which in turn loads the child actor ID's slot set.
 // This tracking allows the mod to reload the parent actor's slot set when the child actor's spawning is finished.
@@ -36,55 +72,373 @@ bool auto_slot_loading_enabled = false;
 
 struct ActorIdStack {
     PlayState* play;
-    ActorId ids[SLOT_SET_STACK_SIZE];
+    SlotSetId ids[SLOT_SET_STACK_SIZE];
+    // The set for each ID, or NULL if the ID has no set and the set below it stays loaded.
+    IdSlots* sets[SLOT_SET_STACK_SIZE];
+    s32 depth;
+};
+
+struct ActorIdStack slot_load_id_stack = {NULL, {0}, {NULL}, 0};
+
+// IDs that need their own set, one bit per vanilla actor ID followed by one per effect type. Every other ID is trivial:
+// its objects are all in the global set, so its hooks run with the global set loaded and skip the stack entirely. IDs
+// start out trivial and get marked the first time they need an object the global set doesn't have, or when objects get
+// added to their set. Most effect types only ever use persistent objects, so this also keeps their hooks from switching
+// sets. Actor IDs added by other mods and variant sets always use their own set.
+u32 id_needs_set_bits[(ACTOR_ID_MAX + EFFECT_SS_TYPE_MAX + 31) / 32];
+
+// Every actor or effect hook gets an entry here, whether or not it pushed a set, so that the return hooks know what to pop.
+struct ActorHookStack {
+    PlayState* play;
+    SlotSetId ids[SLOT_SET_STACK_SIZE];
+    bool pushed[SLOT_SET_STACK_SIZE];
+    // The actor whose Draw or Update the hook is running, or NULL for spawns and effects.
+    Actor* actors[SLOT_SET_STACK_SIZE];
+    // The guest address of the actor function the hook wraps, or 0. Lookups are attributed to it, see pollution.c.
+    u32 callers[SLOT_SET_STACK_SIZE];
     s32 depth;
 };
 
-void load_slots(PlayState* play, ActorId id);
-void unload_slots(PlayState* play, ActorId id);
+struct ActorHookStack actor_hook_stack = {NULL, {0}, {false}, {NULL}, {0}, 0};
+
+void load_slots(PlayState* play);
+void unload_slots(PlayState* play, SlotSetId id, IdSlots* id_slots);
 void print_context(ObjectContext* objectCtx);
+void mark_id_needs_set(SlotSetId id);
+
+RECOMP_CALLBACK("*", recomp_on_init) void auto_slots_on_init() {
+    id_slots_map = recomputil_create_u32_value_hashmap();
+    shared_slots_map = recomputil_create_u32_value_hashmap();
+}
+
+u32 hash_id_slots(IdSlots* id_slots) {
+    u32 hash = 0x811C9DC5;
+
+    hash = (hash ^ id_slots->numEntries) * 0x01000193;
+    hash = (hash ^ id_slots->numShadowEntries) * 0x01000193;
+    for (s32 i = 0; i < id_slots->numEntries; i++) {
+        hash = (hash ^ (u16)id_slots->ids[i]) * 0x01000193;
+    }
+    for (s32 i = OBJECT_SLOT_COUNT; i < OBJECT_SLOT_COUNT + id_slots->numShadowEntries; i++) {
+        hash = (hash ^ (u16)id_slots->ids[i]) * 0x01000193;
+    }
+    return hash;
+}
+
+bool id_slots_equal(IdSlots* a, IdSlots* b) {
+    if (a->numEntries != b->numEntries || a->numShadowEntries != b->numShadowEntries) {
+        return false;
+    }
+    for (s32 i = 0; i < a->numEntries; i++) {
+        if (a->ids[i] != b->ids[i]) {
+            return false;
+        }
+    }
+    for (s32 i = OBJECT_SLOT_COUNT; i < OBJECT_SLOT_COUNT + a->numShadowEntries; i++) {
+        if (a->ids[i] != b->ids[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+IdSlots* clone_id_slots(IdSlots* src) {
+    IdSlots* id_slots = recomp_alloc(sizeof(IdSlots));
+
+    for (s32 i = 0; i < src->numEntries; i++) {
+        id_slots->ids[i] = src->ids[i];
+    }
+    // recomp_alloc doesn't clear the memory, and load_slots_impl copies the whole window.
+    for (s32 i = src->numEntries; i < OBJECT_SLOT_COUNT; i++) {
+        id_slots->ids[i] = 0;
+    }
+    for (s32 i = OBJECT_SLOT_COUNT; i < OBJECT_SLOT_COUNT + src->numShadowEntries; i++) {
+        id_slots->ids[i] = src->ids[i];
+    }
+    id_slots->numEntries = src->numEntries;
+    id_slots->numShadowEntries = src->numShadowEntries;
+    id_slots->nextVictimSlot = src->nextVictimSlot;
+    id_slots->numBytes = src->numBytes;
+    id_slots->refCount = 0;
+    id_slots->interned = false;
+    id_slots->hash = 0;
+    return id_slots;
+}
+
+void unintern_id_slots(IdSlots* id_slots) {
+    if (id_slots->interned) {
+        recomputil_u32_value_hashmap_erase(shared_slots_map, id_slots->hash);
+        id_slots->interned = false;
+    }
+}
+
+void release_id_slots(IdSlots* id_slots) {
+    id_slots->refCount--;
+    if (id_slots->refCount == 0) {
+        unintern_id_slots(id_slots);
+        recomp_free(id_slots);
+    }
+}
+
+// Binds an ID to a set, releasing the set it was bound to before. Stack entries for the ID are updated to match.
+void bind_id_slots(SlotSetId id, IdSlots* id_slots) {
+    unsigned long prev_id_slots;
+    bool had_prev = recomputil_u32_value_hashmap_get(id_slots_map, (u32)id, &prev_id_slots);
+
+    id_slots->refCount++;
+    recomputil_u32_value_hashmap_insert(id_slots_map, (u32)id, (unsigned long)id_slots);
+    slot_sets_generation++;
+
+    for (s32 i = 0; i < slot_load_id_stack.depth; i++) {
+        if (slot_load_id_stack.ids[i] == id) {
+            slot_load_id_stack.sets[i] = id_slots;
+        }
+    }
+
+    if (had_prev) {
+        release_id_slots((IdSlots*)prev_id_slots);
+    }
+}
+
+// Makes the given ID's set safe to modify: if the set is shared with other IDs, the ID gets its own copy of it. The
+// returned set is unregistered from the shared sets until share_id_slots is called for it again.
+IdSlots* detach_id_slots(SlotSetId id, IdSlots* id_slots) {
+    if (id_slots->refCount > 1) {
+        IdSlots* copy = clone_id_slots(id_slots);
+        bind_id_slots(id, copy);
+        return copy;
+    }
+    unintern_id_slots(id_slots);
+    return id_slots;
+}
+
+// Called once a detached set is done being modified. If another set with the same contents is registered, the ID is
+// bound to that one instead and its own copy is released. Returns the set the ID ends up bound to.
+u32 get_id_slots_bytes(IdSlots* id_slots) {
+    u32 bytes = 0;
+
+    for (s32 i = 0; i < id_slots->numEntries; i++) {
+        bytes += object_cache_get_object_size(ABS_ALT(id_slots->ids[i]));
+    }
+    for (s32 i = OBJECT_SLOT_COUNT; i < OBJECT_SLOT_COUNT + id_slots->numShadowEntries; i++) {
+        bytes += object_cache_get_object_size(ABS_ALT(id_slots->ids[i]));
+    }
+    return bytes;
+}
+
+IdSlots* share_id_slots(SlotSetId id, IdSlots* id_slots) {
+    unsigned long existing;
+    u32 hash = hash_id_slots(id_slots);
+
+    id_slots->numBytes = get_id_slots_bytes(id_slots);
+    slot_sets_generation++;
+
+    if (recomputil_u32_value_hashmap_get(shared_slots_map, hash, &existing)) {
+        IdSlots* shared = (IdSlots*)existing;
+        if (shared != id_slots && id_slots_equal(shared, id_slots)) {
+            bind_id_slots(id, shared);
+            return shared;
+        }
+        // Either this set is already registered, or a different set owns the hash and this one stays unshared.
+        return id_slots;
+    }
+
+    id_slots->hash = hash;
+    id_slots->interned = true;
+    recomputil_u32_value_hashmap_insert(shared_slots_map, hash, (unsigned long)id_slots);
+    return id_slots;
+}
+
+void add_known_set_id(SlotSetId id) {
+    if (num_known_set_ids == known_set_ids_capacity) {
+        u32 new_capacity = known_set_ids_capacity == 0 ? 256 : known_set_ids_capacity * 2;
+        SlotSetId* new_list = recomp_alloc(new_capacity * sizeof(SlotSetId));
+        for (u32 i = 0; i < num_known_set_ids; i++) {
+            new_list[i] = known_set_ids[i];
+        }
+        if (known_set_ids != NULL) {
+            recomp_free(known_set_ids);
+        }
+        known_set_ids = new_list;
+        known_set_ids_capacity = new_capacity;
+    }
+    known_set_ids[num_known_set_ids++] = id;
+}
+
+// New IDs start out with the persistent objects, which is usually the same as an existing shared set.
+IdSlots* create_id_slots(SlotSetId id) {
+    IdSlots* id_slots = clone_id_slots(&persistent_slots);
+
+    add_known_set_id(id);
+    bind_id_slots(id, id_slots);
+    id_slots = share_id_slots(id, id_slots);
+
+    // Variant sets also get the objects registered for their actor ID.
+    if (slot_sets_initialized && SLOT_SET_ACTOR_ID(id) != id) {
+        unsigned long bound_id_slots;
+        apply_registered_variant_objects(id);
+        recomputil_u32_value_hashmap_get(id_slots_map, (u32)id, &bound_id_slots);
+        id_slots = (IdSlots*)bound_id_slots;
+    }
+    return id_slots;
+}
+
+// Returns the ID's set, or NULL if the ID doesn't have one yet. Unlike get_id_slots, this never creates a set.
+IdSlots* find_id_slots(SlotSetId id) {
+    unsigned long id_slots;
+
+    if (id >= 0 && recomputil_u32_value_hashmap_get(id_slots_map, (u32)id, &id_slots)) {
+        return (IdSlots*)id_slots;
+    }
+    return NULL;
+}
+
+IdSlots* get_id_slots(SlotSetId id) {
+    IdSlots* id_slots;
+
+    if (id < 0) {
+        return NULL;
+    }
+    id_slots = find_id_slots(id);
+    return id_slots != NULL ? id_slots : create_id_slots(id);
+}
+
+u32 get_slot_set_sizes(u32* out, u32 max_sets) {
+    for (u32 i = 0; i < num_known_set_ids && i < max_sets; i++) {
+        // Only reads the sets, so it mustn't create any as a side effect of publishing metrics.
+        IdSlots* id_slots = find_id_slots(known_set_ids[i]);
+        out[i * 3] = (u32)known_set_ids[i];
+        out[i * 3 + 1] = id_slots != NULL ? (id_slots->numShadowEntries << 16) | id_slots->numEntries : 0;
+        out[i * 3 + 2] = id_slots != NULL ? id_slots->numBytes : 0;
+    }
+    return num_known_set_ids;
+}
+
+u32 get_num_shared_slot_sets(void) {
+    return recomputil_u32_value_hashmap_size(shared_slots_map);
+}
+
+void mark_referenced_object(bool* referenced, s16 id) {
+    id = ABS_ALT(id);
+    if (id > 0 && id < OBJECT_ID_MAX) {
+        referenced[id] = true;
+    }
+}
+
+void mark_id_slots_objects(IdSlots* id_slots, bool* referenced) {
+    for (s32 i = 0; i < id_slots->numEntries; i++) {
+        mark_referenced_object(referenced, id_slots->ids[i]);
+    }
+    for (s32 i = OBJECT_SLOT_COUNT; i < OBJECT_SLOT_COUNT + id_slots->numShadowEntries; i++) {
+        mark_referenced_object(referenced, id_slots->ids[i]);
+    }
+}
+
+void mark_referenced_objects(PlayState* play, bool* referenced) {
+    for (s32 i = 0; i < play->objectCtx.numEntries; i++) {
+        mark_referenced_object(referenced, play->objectCtx.slots[i].id);
+    }
+    if (slot_load_id_stack.depth != 0) {
+        for (s32 i = 0; i < global_slots.numEntries; i++) {
+            mark_referenced_object(referenced, global_slots.ids[i]);
+        }
+    }
+    for (s32 i = 0; i < slot_load_id_stack.depth; i++) {
+        if (slot_load_id_stack.sets[i] != NULL) {
+            mark_id_slots_objects(slot_load_id_stack.sets[i], referenced);
+        }
+    }
+    for (s32 category = 0; category < ACTORCAT_MAX; category++) {
+        for (Actor* actor = play->actorCtx.actorLists[category].first; actor != NULL; actor = actor->next) {
+            // Only reads the sets, so it mustn't create any for actors whose ID doesn't have one yet.
+            IdSlots* id_slots = find_id_slots(get_actor_set_id(actor));
+            if (id_slots != NULL) {
+                mark_id_slots_objects(id_slots, referenced);
+            }
+        }
+    }
+    // Effects aren't tracked individually, so every effect type's set counts as in use.
+    for (u32 i = 0; i < num_known_set_ids; i++) {
+        IdSlots* id_slots = find_id_slots(known_set_ids[i]);
+        if (id_slots != NULL && known_set_ids[i] >= EFFECT_SLOT_SET_ID_BASE &&
+            known_set_ids[i] < EFFECT_SLOT_SET_ID_BASE + EFFECT_SS_TYPE_MAX) {
+            mark_id_slots_objects(id_slots, referenced);
+        }
+    }
+}
+
+// Copies the object context's window into the given ID's set. Returns the set the ID is bound to afterwards.
+IdSlots* write_back_slots(ObjectContext* objectCtx, SlotSetId id, IdSlots* id_slots) {
+    // The set now holds whatever was loaded into the window, so the ID can't run with the global set anymore.
+    mark_id_needs_set(id);
+    id_slots = detach_id_slots(id, id_slots);
+    // The persistent objects at the start of the window never change, see load_slots_impl.
+    for (int i = persistent_slots.numEntries; i < OBJECT_SLOT_COUNT; i++) {
+        id_slots->ids[i] = objectCtx->slots[i].id;
+    }
+    id_slots->numEntries = objectCtx->numEntries;
+    slot_metrics.windowCopies++;
+    return share_id_slots(id, id_slots);
+}
 
-bool push_actor_stack(struct ActorIdStack *actor_stack, ActorId id, PlayState* play) {
+bool push_actor_stack(struct ActorIdStack *actor_stack, SlotSetId id, PlayState* play) {
     if (actor_stack->depth < SLOT_SET_STACK_SIZE) {
         actor_stack->ids[actor_stack->depth] = id;
+        actor_stack->sets[actor_stack->depth] = get_id_slots(id);
         actor_stack->play = play;
         actor_stack->depth++;
         return true;
     } else {
-        recomp_printf("Warning: Actor ID stack overflow, max depth is %d\n", SLOT_SET_STACK_SIZE);
+        SLOT_LOG(SLOT_LOG_WARNINGS, "Warning: Actor ID stack overflow, max depth is %d\n", SLOT_SET_STACK_SIZE);
     }
     return false;
 }
 
-ActorId pop_actor_stack(struct ActorIdStack *actor_stack) {
+SlotSetId pop_actor_stack(struct ActorIdStack *actor_stack) {
     if (actor_stack->depth > 0) {
         actor_stack->depth--;
         return actor_stack->ids[actor_stack->depth];
     } else {
-        recomp_printf("Warning: Actor ID stack underflow\n");
+        SLOT_LOG(SLOT_LOG_WARNINGS, "Warning: Actor ID stack underflow\n");
     }
-    return ACTOR_ID_MAX;
+    return SLOT_SET_ID_NONE;
 }
 
-ActorId get_actor_stack_top(struct ActorIdStack *actor_stack) {
+SlotSetId get_actor_stack_top(struct ActorIdStack *actor_stack) {
     if (actor_stack->depth > 0) {
         return actor_stack->ids[actor_stack->depth - 1];
     }
-    recomp_printf("Warning: Actor ID stack is empty, returning ACTOR_ID_MAX\n");
-    return ACTOR_ID_MAX;
+    SLOT_LOG(SLOT_LOG_WARNINGS, "Warning: Actor ID stack is empty, returning SLOT_SET_ID_NONE\n");
+    return SLOT_SET_ID_NONE;
+}
+
+// Returns the index of the topmost stack entry below the given depth that has a set, or -1 if the global set is the one
+// loaded below that depth.
+s32 get_loaded_set_index(struct ActorIdStack *actor_stack, s32 depth) {
+    for (s32 i = depth - 1; i >= 0; i--) {
+        if (actor_stack->sets[i] != NULL) {
+            return i;
+        }
+    }
+    return -1;
 }
 
-void on_push_to_actor_stack(struct ActorIdStack *actor_stack, ActorId id, PlayState* play) {
+void on_push_to_actor_stack(struct ActorIdStack *actor_stack, SlotSetId id, PlayState* play) {
     if (push_actor_stack(actor_stack, id, play)) {
+        slot_metrics.stackDepth = actor_stack->depth;
+        if (slot_metrics.stackDepth > slot_metrics.maxStackDepth) {
+            slot_metrics.maxStackDepth = slot_metrics.stackDepth;
+        }
         auto_slot_loading_enabled = true;
-        load_slots(actor_stack->play, get_actor_stack_top(actor_stack));
+        load_slots(actor_stack->play);
     }
 }
 
 void on_pop_from_actor_stack(struct ActorIdStack *actor_stack) {
-    ActorId popped_id = pop_actor_stack(actor_stack);
-    if (popped_id != ACTOR_ID_MAX) {
-        unload_slots(actor_stack->play, popped_id);
+    SlotSetId popped_id = pop_actor_stack(actor_stack);
+    slot_metrics.stackDepth = actor_stack->depth;
+    if (popped_id != SLOT_SET_ID_NONE) {
+        unload_slots(actor_stack->play, popped_id, actor_stack->sets[actor_stack->depth]);
         if (actor_stack->depth == 0) {
             // If the stack is empty, reset the auto slot loading state.
             actor_stack->play = NULL;
@@ -95,18 +449,414 @@ void on_pop_from_actor_stack(struct ActorIdStack *actor_stack) {
     }
 }
 
-struct ActorIdStack slot_load_id_stack = {NULL, {0}, 0};
+// Returns the ID's bit in id_needs_set_bits, or -1 for IDs that always use their own set.
+s32 get_id_needs_set_bit(SlotSetId id) {
+    if (id >= 0 && id < ACTOR_ID_MAX) {
+        return id;
+    }
+    if (id >= EFFECT_SLOT_SET_ID_BASE && id < EFFECT_SLOT_SET_ID_BASE + EFFECT_SS_TYPE_MAX) {
+        return ACTOR_ID_MAX + id - EFFECT_SLOT_SET_ID_BASE;
+    }
+    return -1;
+}
+
+bool id_needs_set(SlotSetId id) {
+    s32 bit = get_id_needs_set_bit(id);
+
+    if (id < 0) {
+        return false;
+    }
+    return bit == -1 || (id_needs_set_bits[bit / 32] & (1 << (bit % 32)));
+}
+
+void mark_id_needs_set(SlotSetId id) {
+    s32 bit = get_id_needs_set_bit(id);
+
+    if (bit != -1) {
+        id_needs_set_bits[bit / 32] |= 1 << (bit % 32);
+    }
+}
+
+// Debug check for trivial IDs: a set that holds anything the global set doesn't have at the same slot means the ID should
+// have been marked as needing its set, and its actors' objectSlots would point into the wrong window if the hook ran with
+// the global set. Reports the ID and marks it, so the hook gets its set after all.
+bool verify_trivial_id(SlotSetId id, ObjectContext* objectCtx) {
+    IdSlots* id_slots = find_id_slots(id);
+    bool trivial;
+
+    if (id_slots == NULL) {
+        return true;
+    }
+    // Sets seeded from the global set (see seed_trivial_id_slots) match the start of its window.
+    trivial = id_slots->numShadowEntries == 0 && id_slots->numEntries <= objectCtx->numEntries;
+    for (s32 i = persistent_slots.numEntries; trivial && i < id_slots->numEntries; i++) {
+        trivial = id_slots->ids[i] == objectCtx->slots[i].id;
+    }
+    if (trivial) {
+        return true;
+    }
+    SLOT_LOG(SLOT_LOG_WARNINGS, "Warning: Trivial ID 0x%04X (%s) has %d objects in its set that the global set skips\n",
+             id, get_actor_define_string(id),
+             id_slots->numEntries - persistent_slots.numEntries + id_slots->numShadowEntries);
+    mark_id_needs_set(id);
+    return false;
+}
+
+// A trivial ID that has to load its own set, because its hook runs inside the hook of an ID with a set, gets its set seeded
+// with the global set's window first. The ID's other actors found their objects in the global set, and the set has to
+// keep those objects at the same slots in case the ID gets marked as needing its set while it's loaded.
+void seed_trivial_id_slots(SlotSetId id) {
+    IdSlots* id_slots = get_id_slots(id);
+    bool seeded = id_slots != NULL && id_slots->numEntries == global_slots.numEntries;
+
+    for (s32 i = persistent_slots.numEntries; seeded && i < global_slots.numEntries; i++) {
+        seeded = id_slots->ids[i] == global_slots.ids[i];
+    }
+    if (id_slots == NULL || seeded) {
+        return;
+    }
+
+    id_slots = detach_id_slots(id, id_slots);
+    for (s32 i = persistent_slots.numEntries; i < OBJECT_SLOT_COUNT; i++) {
+        id_slots->ids[i] = i < global_slots.numEntries ? global_slots.ids[i] : 0;
+    }
+    id_slots->numEntries = global_slots.numEntries;
+    slot_metrics.windowCopies++;
+    share_id_slots(id, id_slots);
+}
+
+void on_enter_set_hook(SlotSetId id, PlayState* play) {
+    u32 start = profiler_enabled ? profiler_now() : 0;
+    s32 index = actor_hook_stack.depth++;
+
+    // Trivial IDs only skip their set when the global set is loaded, since that's the set their objects are in.
+    if (index >= SLOT_SET_STACK_SIZE) {
+        on_push_to_actor_stack(&slot_load_id_stack, id, play);
+        return;
+    }
+    slot_sets_in_use = true;
+    actor_hook_stack.play = play;
+    actor_hook_stack.ids[index] = id;
+    actor_hook_stack.actors[index] = NULL;
+    actor_hook_stack.callers[index] = 0;
+    actor_hook_stack.pushed[index] = slot_load_id_stack.depth != 0 || id_needs_set(id) ||
+                                     (slot_verification_enabled && !verify_trivial_id(id, &play->objectCtx));
+    if (actor_hook_stack.pushed[index]) {
+        if (slot_load_id_stack.depth != 0 && !id_needs_set(id)) {
+            seed_trivial_id_slots(id);
+        }
+        on_push_to_actor_stack(&slot_load_id_stack, id, play);
+    }
+    if (profiler_enabled) {
+        profiler_record_hook_enter(index, start);
+    }
+}
+
+// Enters a hook for an ID whose set is already loaded by an enclosing hook, so nothing needs to be switched. The entry
+// still goes onto the hook stack so that the return hook pops the right thing.
+void on_enter_loaded_set_hook(SlotSetId id, PlayState* play) {
+    u32 start = profiler_enabled ? profiler_now() : 0;
+    s32 index = actor_hook_stack.depth;
+
+    if (index >= SLOT_SET_STACK_SIZE || index == 0 || actor_hook_stack.ids[index - 1] != id) {
+        on_enter_set_hook(id, play);
+        return;
+    }
+    actor_hook_stack.depth++;
+    actor_hook_stack.ids[index] = id;
+    actor_hook_stack.actors[index] = NULL;
+    actor_hook_stack.callers[index] = 0;
+    actor_hook_stack.pushed[index] = false;
+    // Every hook's exit adds the time its enter took, so this has to be recorded even though nothing was switched.
+    if (profiler_enabled) {
+        profiler_record_hook_enter(index, start);
+    }
+}
+
+// Enters a hook that's known not to look up any objects, so the set that's loaded stays loaded. The entry still goes onto
+// the hook stack so that the return hook pops the right thing.
+void on_enter_unloaded_set_hook(SlotSetId id, PlayState* play) {
+    u32 start = profiler_enabled ? profiler_now() : 0;
+    s32 index = actor_hook_stack.depth;
+
+    if (index >= SLOT_SET_STACK_SIZE) {
+        on_enter_set_hook(id, play);
+        return;
+    }
+    actor_hook_stack.depth++;
+    actor_hook_stack.ids[index] = id;
+    actor_hook_stack.actors[index] = NULL;
+    actor_hook_stack.callers[index] = 0;
+    actor_hook_stack.pushed[index] = false;
+    if (profiler_enabled) {
+        profiler_record_hook_enter(index, start);
+    }
+}
+
+void on_exit_set_hook() {
+    u32 start = profiler_enabled ? profiler_now() : 0;
+    s32 index;
+
+    if (actor_hook_stack.depth <= 0) {
+        SLOT_LOG(SLOT_LOG_WARNINGS, "Warning: Actor hook stack underflow\n");
+        return;
+    }
+    index = --actor_hook_stack.depth;
+    if (index >= SLOT_SET_STACK_SIZE || actor_hook_stack.pushed[index]) {
+        on_pop_from_actor_stack(&slot_load_id_stack);
+    }
+    if (profiler_enabled && index < SLOT_SET_STACK_SIZE) {
+        profiler_record_hook_exit(index, actor_hook_stack.ids[index], start);
+    }
+}
+
+// Records the actor whose hook was just entered and the actor function the hook wraps. The actor's objectSlot is kept out
+// of eviction (see pick_victim_slot), and the function is what lookups during the hook are attributed to.
+void set_hook_actor(Actor* actor, ActorFunc func) {
+    s32 top = actor_hook_stack.depth - 1;
+
+    if (top >= 0 && top < SLOT_SET_STACK_SIZE) {
+        actor_hook_stack.actors[top] = actor;
+        actor_hook_stack.callers[top] = (u32)func;
+    }
+}
+
+// Returns the guest address of the actor function whose hook is running, or 0 outside of actor Draw and Update hooks.
+u32 get_hook_caller(void) {
+    if (actor_hook_stack.depth > 0 && actor_hook_stack.depth <= SLOT_SET_STACK_SIZE) {
+        return actor_hook_stack.callers[actor_hook_stack.depth - 1];
+    }
+    return 0;
+}
+
+// Returns the set ID of the innermost actor or effect hook that's running, or AUTO_OBJECT_SLOTS_GLOBAL_SET outside of
+// any hook.
+SlotSetId get_hook_set_id(void) {
+    if (actor_hook_stack.depth > 0 && actor_hook_stack.depth <= SLOT_SET_STACK_SIZE) {
+        return actor_hook_stack.ids[actor_hook_stack.depth - 1];
+    }
+    return AUTO_OBJECT_SLOTS_GLOBAL_SET;
+}
+
+// Called when an object lookup misses in the global set. If the lookup comes from the hook of an ID that was treated as
+// trivial, the ID turns out to need its own set after all, so its set gets pushed for the rest of the hook.
+// The set is seeded with the global set's window first, so that actors of this ID that found their objects in the
+// global set keep valid objectSlots. Returns true if a set was pushed.
+bool promote_trivial_hook_id(ObjectContext* objectCtx, s16 objectId) {
+    s32 top = actor_hook_stack.depth - 1;
+    SlotSetId id;
+
+    if (top < 0 || top >= SLOT_SET_STACK_SIZE || actor_hook_stack.pushed[top] || slot_load_id_stack.depth != 0 ||
+        objectCtx != &actor_hook_stack.play->objectCtx) {
+        return false;
+    }
+    id = actor_hook_stack.ids[top];
+    if (id < 0) {
+        return false;
+    }
+
+    // The object would have been appended to the global set if the ID hadn't been promoted, so it's what the ID would
+    // have cost the global set. The hook's caller is still the one that looked the object up.
+    pollution_record_promotion(objectId, id);
+    mark_id_needs_set(id);
+    write_back_slots(objectCtx, id, get_id_slots(id));
+    actor_hook_stack.pushed[top] = true;
+    on_push_to_actor_stack(&slot_load_id_stack, id, actor_hook_stack.play);
+    return true;
+}
+
+// Actors whose objectSlot pointed at a window slot that got swapped out, along with the object they were using.
+// The object is swapped back into the window and the actor's objectSlot is updated the next time the actor's hooks run.
+#define SLOT_REMAP_LIST_SIZE 32
+
+typedef struct {
+    Actor* actor;
+    s16 objectId;
+} SlotRemap;
+
+SlotRemap slot_remaps[SLOT_REMAP_LIST_SIZE];
+s32 num_slot_remaps = 0;
+
+// Slot lifecycle events, see include/auto_object_slots_api.h.
+RECOMP_DECLARE_EVENT(AutoObjectSlots_onObjectLoaded(s16 actorId, s16 objectId, s32 slot, void* segment));
+RECOMP_DECLARE_EVENT(AutoObjectSlots_onObjectEvicted(s16 actorId, s16 objectId, s32 slot, void* segment));
+RECOMP_DECLARE_EVENT(AutoObjectSlots_onObjectInvalidated(s16 actorId, s16 objectId, s32 slot, void* segment));
+
+// Returns the actor ID whose set is currently in the given object context, or AUTO_OBJECT_SLOTS_GLOBAL_SET for the
+// global set.
+s16 get_loaded_set_id(ObjectContext* objectCtx) {
+    if (slot_load_id_stack.play != NULL && objectCtx == &slot_load_id_stack.play->objectCtx) {
+        s32 index = get_loaded_set_index(&slot_load_id_stack, slot_load_id_stack.depth);
+        if (index != -1) {
+            return slot_load_id_stack.ids[index];
+        }
+    }
+    return AUTO_OBJECT_SLOTS_GLOBAL_SET;
+}
+
+// Sets built up in a scene are kept around for a while after the scene is left, so that re-entering a recently visited
+// scene starts every ID off with the objects it used last time instead of looking them all up again. The retained sets
+// are keyed by scene and ID, and the least recently retained ones are dropped when the list is full.
+#define RETAINED_SETS_MAX 256
+
+typedef struct {
+    s16 sceneId;
+    SlotSetId id;
+    // Sets are only restored if the new scene's persistent objects are exactly the ones the set was built with.
+    u8 numPersistentEntries;
+    IdSlots* set;
+    u32 lastUse;
+} RetainedSet;
+
+RetainedSet retained_sets[RETAINED_SETS_MAX];
+u32 num_retained_sets = 0;
+u32 retained_sets_clock = 0;
+
+void retain_id_slots(SlotSetId id, IdSlots* id_slots) {
+    RetainedSet* entry = NULL;
+
+    for (u32 i = 0; i < num_retained_sets; i++) {
+        if (retained_sets[i].sceneId == slot_sets_scene_id && retained_sets[i].id == id) {
+            entry = &retained_sets[i];
+            release_id_slots(entry->set);
+            break;
+        }
+    }
+
+    if (entry == NULL) {
+        if (num_retained_sets == RETAINED_SETS_MAX) {
+            u32 oldest = 0;
+            for (u32 i = 1; i < num_retained_sets; i++) {
+                if (retained_sets[i].lastUse < retained_sets[oldest].lastUse) {
+                    oldest = i;
+                }
+            }
+            release_id_slots(retained_sets[oldest].set);
+            retained_sets[oldest] = retained_sets[--num_retained_sets];
+        }
+        entry = &retained_sets[num_retained_sets++];
+    }
+
+    id_slots->refCount++;
+    entry->sceneId = slot_sets_scene_id;
+    entry->id = id;
+    entry->numPersistentEntries = persistent_slots.numEntries;
+    entry->set = id_slots;
+    entry->lastUse = retained_sets_clock++;
+}
+
+bool has_persistent_prefix(IdSlots* id_slots) {
+    for (s32 i = 0; i < persistent_slots.numEntries; i++) {
+        if (id_slots->ids[i] != persistent_slots.ids[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Binds every ID that has a retained set for the current scene back to that set.
+void restore_retained_sets(void) {
+    for (u32 i = 0; i < num_retained_sets; i++) {
+        RetainedSet* entry = &retained_sets[i];
+        IdSlots* id_slots = entry->set;
+
+        if (entry->sceneId != slot_sets_scene_id || entry->numPersistentEntries != persistent_slots.numEntries ||
+            !has_persistent_prefix(id_slots)) {
+            continue;
+        }
+
+        bind_id_slots(entry->id, id_slots);
+        share_id_slots(entry->id, id_slots);
+        mark_id_needs_set(entry->id);
+        entry->lastUse = retained_sets_clock++;
+
+        for (int slot = persistent_slots.numEntries; slot < id_slots->numEntries; slot++) {
+            s16 objectId = ABS_ALT(id_slots->ids[slot]);
+            AutoObjectSlots_onObjectLoaded(entry->id, objectId, slot, object_cache_peek_segment(objectId));
+        }
+        for (int j = OBJECT_SLOT_COUNT; j < OBJECT_SLOT_COUNT + id_slots->numShadowEntries; j++) {
+            s16 objectId = ABS_ALT(id_slots->ids[j]);
+            AutoObjectSlots_onObjectLoaded(entry->id, objectId, OBJECT_SLOT_NONE, object_cache_peek_segment(objectId));
+        }
+    }
+}
 
 void propagate_persistent_slots(ObjectContext* objectCtx) {
-    recomp_printf("Copying %d persistent slots\n", objectCtx->numPersistentEntries);
-    for (int i = 0; i < ACTOR_ID_MAX; i++) {
-        // Copy the ids and objects from the persistent slots in the global object context.
-        for (int slot = 0; slot < objectCtx->numPersistentEntries; slot++) {
-            all_id_slots[i].ids[slot]     = objectCtx->slots[slot].id;
-            all_id_slots[i].objects[slot] = objectCtx->slots[slot].segment;
+    PlayState* play = (PlayState*)((u8*)objectCtx - offsetof(PlayState, objectCtx));
+
+    // Keep the sets of the scene that's ending before they're reset.
+    if (slot_sets_initialized && slot_sets_in_use) {
+        for (u32 i = 0; i < num_known_set_ids; i++) {
+            IdSlots* id_slots = get_id_slots(known_set_ids[i]);
+            if (id_slots->numEntries > persistent_slots.numEntries || id_slots->numShadowEntries != 0) {
+                retain_id_slots(known_set_ids[i], id_slots);
+            }
+            if (shared_prefix_enabled) {
+                shared_prefix_count_set(known_set_ids[i], id_slots, persistent_slots.numEntries,
+                                        id_needs_set(known_set_ids[i]));
+            }
+        }
+        if (shared_prefix_enabled) {
+            shared_prefix_update();
+        }
+    }
+    slot_sets_scene_id = play->sceneId;
+    slot_sets_in_use = false;
+    if (shared_prefix_enabled) {
+        shared_prefix_append(objectCtx, play->sceneId);
+    }
+    object_cache_set_persistent_segments(objectCtx);
+    verify_reset();
+
+    SLOT_LOG(SLOT_LOG_INFO, "Copying %d persistent slots\n", objectCtx->numPersistentEntries);
+    for (int slot = 0; slot < objectCtx->numPersistentEntries; slot++) {
+        persistent_slots.ids[slot] = objectCtx->slots[slot].id;
+    }
+    persistent_slots.numEntries = objectCtx->numPersistentEntries;
+
+    persistent_slots.numShadowEntries = 0;
+    persistent_slots.nextVictimSlot = 0;
+
+    // Notify listeners about the objects that are being dropped from each ID's set.
+    if (slot_sets_initialized) {
+        for (u32 i = 0; i < num_known_set_ids; i++) {
+            SlotSetId id = known_set_ids[i];
+            IdSlots* id_slots = get_id_slots(id);
+            for (int slot = objectCtx->numPersistentEntries; slot < id_slots->numEntries; slot++) {
+                s16 objectId = ABS_ALT(id_slots->ids[slot]);
+                AutoObjectSlots_onObjectInvalidated(id, objectId, slot, object_cache_peek_segment(objectId));
+            }
+            for (int j = OBJECT_SLOT_COUNT; j < OBJECT_SLOT_COUNT + id_slots->numShadowEntries; j++) {
+                s16 objectId = ABS_ALT(id_slots->ids[j]);
+                AutoObjectSlots_onObjectInvalidated(id, objectId, OBJECT_SLOT_NONE, object_cache_peek_segment(objectId));
+            }
+        }
+    }
+
+    // Every set is reset to just the persistent objects, so all of the IDs can share a single set again. The old sets
+    // are unregistered first so that none of them can be mistaken for the new one, and get freed as the IDs are rebound.
+    for (u32 i = 0; i < num_known_set_ids; i++) {
+        unintern_id_slots(get_id_slots(known_set_ids[i]));
+    }
+    if (num_known_set_ids != 0) {
+        IdSlots* base_id_slots = clone_id_slots(&persistent_slots);
+        for (u32 i = 0; i < num_known_set_ids; i++) {
+            bind_id_slots(known_set_ids[i], base_id_slots);
+        }
+        share_id_slots(known_set_ids[0], base_id_slots);
+    }
+    num_slot_remaps = 0;
+    // Every ID's set is back to just the persistent objects, so every ID starts out trivial again.
+    for (u32 i = 0; i < ARRAY_COUNT(id_needs_set_bits); i++) {
+        id_needs_set_bits[i] = 0;
+    }
+    restore_retained_sets();
+    slot_sets_initialized = true;
+    apply_registered_actor_objects();
+    for (u32 i = 0; i < num_known_set_ids; i++) {
+        if (SLOT_SET_ACTOR_ID(known_set_ids[i]) != known_set_ids[i]) {
+            apply_registered_variant_objects(known_set_ids[i]);
         }
-        // Set the entry count based on the global object context's persistent entry count.
-        all_id_slots[i].numEntries = objectCtx->numPersistentEntries;
     }
 }
 
@@ -122,63 +872,96 @@ RECOMP_HOOK_RETURN("Object_SpawnPersistent") void after_spawn_persistent() {
     spawn_persistent_ctx = NULL;
 }
 
-void load_slots_impl(ObjectContext* objectCtx, ActorId id) {
-    // Copy the slots from this ID into play's object context.
-    IdSlots* cur_id_slots = &all_id_slots[id];
-    for (int i = 0; i < OBJECT_SLOT_COUNT; i++) {
+// Returns the segment to put into an object context slot for the given object ID. In lazy mode, objects from a room's
+// object list that haven't been looked up yet stay NULL until they are.
+void* get_slot_segment(s16 id) {
+    if (id == 0) {
+        return NULL;
+    }
+    return lazy_scene_objects_enabled ? object_cache_peek_segment(ABS_ALT(id)) : object_cache_get_segment(ABS_ALT(id));
+}
+
+void load_slots_impl(ObjectContext* objectCtx, IdSlots* cur_id_slots) {
+    // Copy the slots from this ID into play's object context. Every set starts with the persistent objects, which are
+    // always in the window already.
+    for (int i = persistent_slots.numEntries; i < OBJECT_SLOT_COUNT; i++) {
         objectCtx->slots[i].id = cur_id_slots->ids[i];
-        objectCtx->slots[i].segment = cur_id_slots->objects[i];
+        objectCtx->slots[i].segment = i < cur_id_slots->numEntries ? get_slot_segment(cur_id_slots->ids[i]) : NULL;
     }
     objectCtx->numEntries = cur_id_slots->numEntries;
+    slot_metrics.windowCopies++;
 }
 
-void load_slots(PlayState* play, ActorId id) {
-    if (id < ACTOR_ID_MAX) {
-        // recomp_printf("Loading slots for ID 0x%04X\n", id);
+void load_slots(PlayState* play) {
+    s32 top = slot_load_id_stack.depth - 1;
+    IdSlots* cur_id_slots = slot_load_id_stack.sets[top];
+
+    if (cur_id_slots != NULL) {
+        s32 parent_index = get_loaded_set_index(&slot_load_id_stack, top);
+        IdSlots* loaded_id_slots = NULL;
+        SLOT_LOG_ID(SLOT_LOG_TRACE, slot_load_id_stack.ids[top], "Loading slots for ID 0x%04X\n",
+                    slot_load_id_stack.ids[top]);
+
+        if (slot_verification_enabled) {
+            verify_before_load(&play->objectCtx, parent_index == -1 ? SLOT_SET_ID_NONE : slot_load_id_stack.ids[parent_index],
+                               parent_index == -1 ? NULL : slot_load_id_stack.sets[parent_index]);
+        }
 
         // If there is no alternate slot set already in use, save the current object context slots as the global set.
-        if (slot_load_id_stack.depth == 1) {
+        if (parent_index == -1) {
             global_slots.numEntries = play->objectCtx.numEntries;
             global_slots.numPersistentEntries = play->objectCtx.numPersistentEntries;
             global_slots.mainKeepSlot = play->objectCtx.mainKeepSlot;
             global_slots.subKeepSlot = play->objectCtx.subKeepSlot;
             for (int i = 0; i < OBJECT_SLOT_COUNT; i++) {
                 global_slots.ids[i] = play->objectCtx.slots[i].id;
-                global_slots.objects[i] = play->objectCtx.slots[i].segment;
-                global_slots.dmaReqs[i] = play->objectCtx.slots[i].dmaReq;
             }
+            global_slots.freeSegment =
+                play->objectCtx.numEntries < OBJECT_SLOT_COUNT ? play->objectCtx.slots[play->objectCtx.numEntries].segment : NULL;
+            slot_metrics.windowCopies++;
         }
-        // Otherwise, save the current object slots into that ID's slots.
+        // Otherwise, save the current object slots into that ID's slots if they were changed.
         else {
-            ActorId parent_id = slot_load_id_stack.ids[slot_load_id_stack.depth - 2];
-            IdSlots* parent_id_slots = &all_id_slots[parent_id];
-            for (int i = 0; i < OBJECT_SLOT_COUNT; i++) {
-                parent_id_slots->ids[i] = play->objectCtx.slots[i].id;
-                parent_id_slots->objects[i] = play->objectCtx.slots[i].segment;
+            loaded_id_slots = slot_load_id_stack.sets[parent_index];
+            if (loaded_slots_dirty) {
+                loaded_id_slots = write_back_slots(&play->objectCtx, slot_load_id_stack.ids[parent_index], loaded_id_slots);
+                // Writing back can rebind the new ID's set too if it's the same ID.
+                cur_id_slots = slot_load_id_stack.sets[top];
             }
-            parent_id_slots->numEntries = play->objectCtx.numEntries;
         }
 
-        // Load the slot set for the given actor ID.
-        load_slots_impl(&play->objectCtx, id);
+        // Load the slot set for the given actor ID, unless the object context already holds that exact set.
+        if (cur_id_slots != loaded_id_slots) {
+            load_slots_impl(&play->objectCtx, cur_id_slots);
+            slot_metrics.setLoads++;
+        } else {
+            slot_metrics.setLoadsSkipped++;
+        }
+        loaded_slots_dirty = false;
         // print_context(&play->objectCtx);
+
+        if (slot_verification_enabled) {
+            verify_after_load(&play->objectCtx, slot_load_id_stack.ids[top], cur_id_slots, slot_load_id_stack.depth);
+        }
     }
 }
 
-void unload_slots(PlayState* play, ActorId id) {
-    if (id < ACTOR_ID_MAX) {
-        // recomp_printf("Unloading slots for ID 0x%04X\n", id);
+void unload_slots(PlayState* play, SlotSetId id, IdSlots* cur_id_slots) {
+    if (cur_id_slots != NULL) {
+        s32 parent_index = get_loaded_set_index(&slot_load_id_stack, slot_load_id_stack.depth);
+        SLOT_LOG_ID(SLOT_LOG_TRACE, id, "Unloading slots for ID 0x%04X\n", id);
+
+        if (slot_verification_enabled) {
+            verify_before_unload(&play->objectCtx, id, cur_id_slots);
+        }
 
-        // Copy the slots from play's object context back into this ID's slots.
-        IdSlots* cur_id_slots = &all_id_slots[id];
-        for (int i = 0; i < OBJECT_SLOT_COUNT; i++) {
-            cur_id_slots->ids[i] = play->objectCtx.slots[i].id;
-            cur_id_slots->objects[i] = play->objectCtx.slots[i].segment;
+        // Copy the slots from play's object context back into this ID's slots if they were changed.
+        if (loaded_slots_dirty) {
+            cur_id_slots = write_back_slots(&play->objectCtx, id, cur_id_slots);
         }
-        cur_id_slots->numEntries = play->objectCtx.numEntries;
 
         // If this is the parent-most actor in the chain, reload the global slot set into the object context.
-        if (slot_load_id_stack.depth == 0) {
+        if (parent_index == -1) {
             // Restore the global context.
             play->objectCtx.numEntries = global_slots.numEntries;
             play->objectCtx.numPersistentEntries = global_slots.numPersistentEntries;
@@ -186,13 +969,23 @@ void unload_slots(PlayState* play, ActorId id) {
             play->objectCtx.subKeepSlot = global_slots.subKeepSlot;
             for (int i = 0; i < OBJECT_SLOT_COUNT; i++) {
                 play->objectCtx.slots[i].id = global_slots.ids[i];
-                play->objectCtx.slots[i].segment = global_slots.objects[i];
-                play->objectCtx.slots[i].dmaReq = global_slots.dmaReqs[i];
+                play->objectCtx.slots[i].segment = i < global_slots.numEntries ? get_slot_segment(global_slots.ids[i]) : NULL;
+            }
+            if (global_slots.numEntries < OBJECT_SLOT_COUNT) {
+                play->objectCtx.slots[global_slots.numEntries].segment = global_slots.freeSegment;
             }
+            slot_metrics.windowCopies++;
         }
-        // Otherwise, load the parent actor's slot set.
-        else {
-            load_slots_impl(&play->objectCtx, get_actor_stack_top(&slot_load_id_stack));
+        // Otherwise, load the parent actor's slot set unless the object context already holds that exact set.
+        else if (slot_load_id_stack.sets[parent_index] != cur_id_slots) {
+            load_slots_impl(&play->objectCtx, slot_load_id_stack.sets[parent_index]);
+        }
+        loaded_slots_dirty = false;
+
+        if (slot_verification_enabled) {
+            verify_after_unload(&play->objectCtx, id, cur_id_slots,
+                                parent_index == -1 ? SLOT_SET_ID_NONE : slot_load_id_stack.ids[parent_index],
+                                parent_index == -1 ? NULL : slot_load_id_stack.sets[parent_index], slot_load_id_stack.depth + 1);
         }
     }
 }
@@ -207,7 +1000,8 @@ typedef struct {
     /* 0x18 */ u32 updateActorFlagsMask; // Actor will update only if at least 1 actor flag is set in this bitmask
 } UpdateActor_Params;
 
-const char *get_actor_define_string(ActorId id) {
+// Names the actor ID a set ID belongs to. Variant sets are named after their actor ID.
+const char *get_actor_define_string(SlotSetId id) {
     static const char* actor_names[] = {
         #define DEFINE_ACTOR_INTERNAL(_name, enumValue, _alloc, _str) #enumValue,
         #define DEFINE_ACTOR(_name, enumValue, _alloc, _str) #enumValue,
@@ -215,7 +1009,14 @@ const char *get_actor_define_string(ActorId id) {
         #include "tables/actor_table.h"
     };
 
-    return id < ACTOR_ID_MAX ? actor_names[id] : "Unknown";
+    if (id < 0) {
+        return "Global set";
+    }
+    if (id >= EFFECT_SLOT_SET_ID_BASE && id < EFFECT_SLOT_SET_ID_BASE + EFFECT_SS_TYPE_MAX) {
+        return "Effect";
+    }
+    id = SLOT_SET_ACTOR_ID(id);
+    return id >= 0 && id < ACTOR_ID_MAX ? actor_names[id] : "Modded actor";
     #undef DEFINE_ACTOR_INTERNAL
     #undef DEFINE_ACTOR
     #undef DEFINE_ACTOR_UNSET
@@ -224,35 +1025,114 @@ const char *get_actor_define_string(ActorId id) {
 RECOMP_HOOK("Actor_SpawnAsChildAndCutscene") void on_spawn(ActorContext* actorCtx, PlayState* play, s16 index, f32 x, f32 y, f32 z, s16 rotX,
                                      s16 rotY, s16 rotZ, s32 params, u32 csId, u32 halfDaysBits, Actor* parent)
 {
-    on_push_to_actor_stack(&slot_load_id_stack, index, play);
+    SlotSetId id = get_spawn_set_id(index, params);
+
+    // @mod Actors spawned by a batch spawn have their set loaded already, see batch_spawn.c.
+    if (batch_spawn_pending) {
+        batch_spawn_pending = false;
+        on_enter_loaded_set_hook(id, play);
+        return;
+    }
+
+    on_enter_set_hook(id, play);
     if (parent != NULL) {
-        recomp_printf("Spawning child of %-20s (ID: 0x%04X)\n    ",
-                     get_actor_define_string(parent->id), parent->id);
+        SLOT_LOG_ID(SLOT_LOG_INFO, id, "Spawning child of %-20s (ID: 0x%04X)\n    ",
+                    get_actor_define_string(parent->id), parent->id);
     }
-    recomp_printf("Spawning actor %-20s (ID: 0x%04X) stack_depth: %2d\n",
-                 get_actor_define_string(index), index, slot_load_id_stack.depth);
+    SLOT_LOG_ID(SLOT_LOG_INFO, id, "Spawning actor %-20s (ID: 0x%04X) stack_depth: %2d\n",
+                get_actor_define_string(index), index, slot_load_id_stack.depth);
 }
 
 RECOMP_HOOK_RETURN("Actor_SpawnAsChildAndCutscene") void after_spawn() {
-    on_pop_from_actor_stack(&slot_load_id_stack);
+    on_exit_set_hook();
+}
+
+void apply_slot_remap(PlayState* play, Actor* actor) {
+    for (s32 i = 0; i < num_slot_remaps; i++) {
+        if (slot_remaps[i].actor == actor) {
+            s32 slot = Object_GetSlot(&play->objectCtx, slot_remaps[i].objectId);
+            if (slot > OBJECT_SLOT_NONE) {
+                actor->objectSlot = slot;
+            }
+            num_slot_remaps--;
+            slot_remaps[i] = slot_remaps[num_slot_remaps];
+            return;
+        }
+    }
 }
 
 RECOMP_HOOK("Actor_Draw") void on_draw(PlayState* play, Actor* actor) {
-    on_push_to_actor_stack(&slot_load_id_stack, actor->id, play);
+    on_enter_set_hook(get_actor_set_id(actor), play);
+    set_hook_actor(actor, actor->draw);
+    if (num_slot_remaps != 0) {
+        apply_slot_remap(play, actor);
+    }
 }
 
 RECOMP_HOOK_RETURN("Actor_Draw") void after_draw() {
-    on_pop_from_actor_stack(&slot_load_id_stack);
+    on_exit_set_hook();
+}
+
+// Returns true if the actor's objectSlot is loaded in the set the actor's hooks would load, the way Object_IsLoaded would
+// see it with that set in the window. Returns false if that can't be told without creating the set.
+bool actor_object_loaded_in_set(Actor* actor) {
+    SlotSetId id = get_actor_set_id(actor);
+    s32 loaded_index = get_loaded_set_index(&slot_load_id_stack, slot_load_id_stack.depth);
+    IdSlots* id_slots;
+
+    // The window is the set itself: the global set for a trivial ID with nothing loaded, or the ID's own loaded set.
+    if (loaded_index == -1 ? !id_needs_set(id) : slot_load_id_stack.ids[loaded_index] == id) {
+        return true;
+    }
+    id_slots = find_id_slots(id);
+    return id_slots != NULL && actor->objectSlot < id_slots->numEntries && id_slots->ids[actor->objectSlot] > 0;
+}
+
+// Returns true if Actor_UpdateActor is certain to skip the actor's update, because the actor is frozen or its update is
+// masked out. Only the parts of Actor_UpdateActor's checks that can be evaluated exactly are used, so actors that are
+// frozen by the remaining checks (e.g. during a text box) still get their set loaded.
+// A skipped actor only has its collision damage reset, which doesn't look up any objects. Actor_UpdateActor checks that
+// the actor's object is loaded before that though, and kills the actor if it isn't, so the loaded window and the actor's
+// own set both have to pass that check.
+bool actor_skips_update(UpdateActor_Params* params) {
+    Actor* actor = params->actor;
+    ObjectContext* objectCtx = &params->play->objectCtx;
+
+    if (actor->init != NULL || actor->update == NULL) {
+        return false;
+    }
+    if (actor->objectSlot <= OBJECT_SLOT_NONE || actor->objectSlot >= OBJECT_SLOT_COUNT ||
+        objectCtx->slots[actor->objectSlot].id <= 0 || !actor_object_loaded_in_set(actor)) {
+        return false;
+    }
+
+    // Frozen: a freeze exception flag is set and the actor doesn't have it.
+    if (params->freezeExceptionFlag != 0 && !(actor->flags & params->freezeExceptionFlag)) {
+        return true;
+    }
+    // Not frozen, but the update only runs once the freeze timer reaches zero and if the actor matches the flags mask.
+    return actor->freezeTimer > 1 || !(actor->flags & params->updateActorFlagsMask);
 }
 
 RECOMP_HOOK("Actor_UpdateActor") void on_update(UpdateActor_Params* params) {
     PlayState* play = params->play;
     Actor* actor = params->actor;
-    on_push_to_actor_stack(&slot_load_id_stack, actor->id, play);
+
+    // @mod Don't switch sets for actors that aren't going to update.
+    if (actor_skips_update(params)) {
+        on_enter_unloaded_set_hook(get_actor_set_id(actor), play);
+        slot_metrics.frozenSkips++;
+        return;
+    }
+    on_enter_set_hook(get_actor_set_id(actor), play);
+    set_hook_actor(actor, actor->update);
+    if (num_slot_remaps != 0) {
+        apply_slot_remap(play, actor);
+    }
 }
 
 RECOMP_HOOK_RETURN("Actor_UpdateActor") void after_update() {
-    on_pop_from_actor_stack(&slot_load_id_stack);
+    on_exit_set_hook();
 }
 
 void print_context(ObjectContext* objectCtx) {
@@ -276,40 +1156,425 @@ const char *get_obj_define_string(s16 objectId) {
     #undef DEFINE_OBJECT_EMPTY
 }
 
-// Patched to load objects if the slot wasn't found and a free space exists.
-RECOMP_PATCH s32 Object_GetSlot(ObjectContext* objectCtx, s16 objectId) {
+// Returns a bitmask of the window slots that actors with the given set ID use as their objectSlot.
+u64 get_actor_slot_mask(PlayState* play, SlotSetId id) {
+    u64 mask = 0;
+    for (s32 category = 0; category < ACTORCAT_MAX; category++) {
+        for (Actor* actor = play->actorCtx.actorLists[category].first; actor != NULL; actor = actor->next) {
+            if (actor->id == SLOT_SET_ACTOR_ID(id) && actor->objectSlot > OBJECT_SLOT_NONE && get_actor_set_id(actor) == id) {
+                mask |= 1ULL << actor->objectSlot;
+            }
+        }
+    }
+    return mask;
+}
+
+// Returns a bitmask of the window slots that actors with the given set ID whose Draw or Update is running right now use as
+// their objectSlot. Remaps only get applied when an actor's hook is entered, so these actors would keep using a swapped
+// out slot until their hook returns and can't have their slot picked at all.
+u64 get_hook_actor_slot_mask(SlotSetId id) {
+    s32 depth = actor_hook_stack.depth < SLOT_SET_STACK_SIZE ? actor_hook_stack.depth : SLOT_SET_STACK_SIZE;
+    u64 mask = 0;
+
+    for (s32 i = 0; i < depth; i++) {
+        Actor* actor = actor_hook_stack.actors[i];
+        if (actor != NULL && actor->objectSlot > OBJECT_SLOT_NONE && actor->objectSlot < OBJECT_SLOT_COUNT &&
+            get_actor_set_id(actor) == id) {
+            mask |= 1ULL << actor->objectSlot;
+        }
+    }
+    return mask;
+}
+
+void add_slot_remaps(PlayState* play, SlotSetId id, s32 slot, s16 objectId) {
+    for (s32 category = 0; category < ACTORCAT_MAX; category++) {
+        for (Actor* actor = play->actorCtx.actorLists[category].first; actor != NULL; actor = actor->next) {
+            if (actor->id == SLOT_SET_ACTOR_ID(id) && actor->objectSlot == slot && get_actor_set_id(actor) == id) {
+                if (num_slot_remaps < SLOT_REMAP_LIST_SIZE) {
+                    slot_remaps[num_slot_remaps].actor = actor;
+                    slot_remaps[num_slot_remaps].objectId = objectId;
+                    num_slot_remaps++;
+                } else {
+                    SLOT_LOG(SLOT_LOG_WARNINGS, "Warning: Slot remap list is full, max size is %d\n",
+                             SLOT_REMAP_LIST_SIZE);
+                }
+            }
+        }
+    }
+}
+
+// Lookup clock value of each object's most recent lookup, only kept with the least recently used eviction policy. The
+// clock counts lookups rather than frames, so objects looked up on the same frame are still ordered.
+u32 object_lookup_clock = 0;
+u32 object_last_lookup[OBJECT_ID_MAX];
+
+u32 get_object_last_lookup(s16 id) {
+    id = ABS_ALT(id);
+    return id > 0 && id < OBJECT_ID_MAX ? object_last_lookup[id] : 0;
+}
+
+// Picks the non-persistent window slot whose object was looked up the longest time ago. Slots that no actor of this ID
+// uses as its objectSlot are preferred, and excluded slots are never picked, like in pick_victim_slot.
+s32 pick_lru_victim_slot(PlayState* play, SlotSetId id, u64 used_mask, u64 excluded_mask) {
+    ObjectContext* objectCtx = &play->objectCtx;
+    s32 oldest = OBJECT_SLOT_NONE;
+    s32 oldest_used = OBJECT_SLOT_NONE;
+
+    for (s32 slot = objectCtx->numPersistentEntries; slot < OBJECT_SLOT_COUNT; slot++) {
+        u32 last_used = get_object_last_lookup(objectCtx->slots[slot].id);
+        s32* best = (used_mask & (1ULL << slot)) ? &oldest_used : &oldest;
+
+        if (excluded_mask & (1ULL << slot)) {
+            continue;
+        }
+        if (*best == OBJECT_SLOT_NONE || last_used < get_object_last_lookup(objectCtx->slots[*best].id)) {
+            *best = slot;
+        }
+    }
+
+    if (oldest == OBJECT_SLOT_NONE && oldest_used != OBJECT_SLOT_NONE) {
+        oldest = oldest_used;
+        add_slot_remaps(play, id, oldest, ABS_ALT(objectCtx->slots[oldest].id));
+    }
+    return oldest;
+}
+
+// Picks a non-persistent window slot of the active set to move into the shadow entries. Slots that no actor of this ID
+// uses as its objectSlot are preferred. If every slot is in use, the actors using the picked slot get remapped. Slots
+// used by actors of this ID whose hooks are running are never picked, see get_hook_actor_slot_mask, and neither is any
+// slot of an effect type's set while the effect type has live instances.
+s32 pick_victim_slot(PlayState* play, SlotSetId id, IdSlots* id_slots) {
+    ObjectContext* objectCtx = &play->objectCtx;
+    s32 num_candidates = OBJECT_SLOT_COUNT - objectCtx->numPersistentEntries;
+    u64 used_mask;
+    u64 excluded_mask;
+    s32 slot;
+
+    // @mod Effects keep their slots in their own instance data, where they can't be remapped.
+    if (num_candidates <= 0 || effect_set_is_live(id)) {
+        return OBJECT_SLOT_NONE;
+    }
+
+    used_mask = get_actor_slot_mask(play, id);
+    excluded_mask = get_hook_actor_slot_mask(id);
+    if (slot_eviction_policy == SLOT_EVICTION_LEAST_RECENTLY_USED) {
+        return pick_lru_victim_slot(play, id, used_mask, excluded_mask);
+    }
+    for (s32 i = 0; i < num_candidates; i++) {
+        s32 candidate = (id_slots->nextVictimSlot + i) % num_candidates;
+        slot = objectCtx->numPersistentEntries + candidate;
+        if (!((used_mask | excluded_mask) & (1ULL << slot))) {
+            id_slots->nextVictimSlot = (candidate + 1) % num_candidates;
+            return slot;
+        }
+    }
+
+    for (s32 i = 0; i < num_candidates; i++) {
+        s32 candidate = (id_slots->nextVictimSlot + i) % num_candidates;
+        slot = objectCtx->numPersistentEntries + candidate;
+        if (!(excluded_mask & (1ULL << slot))) {
+            id_slots->nextVictimSlot = (candidate + 1) % num_candidates;
+            add_slot_remaps(play, id, slot, ABS_ALT(objectCtx->slots[slot].id));
+            return slot;
+        }
+    }
+    return OBJECT_SLOT_NONE;
+}
+
+// Exchanges a window slot in the object context with an entry in the active set's shadow entries.
+void swap_shadow_entry(ObjectContext* objectCtx, IdSlots* id_slots, s32 shadow_index, s32 slot) {
+    s16 id = id_slots->ids[shadow_index];
+    void* object = get_slot_segment(id);
+    s16 set_id = get_loaded_set_id(objectCtx);
+
+    AutoObjectSlots_onObjectEvicted(set_id, ABS_ALT(objectCtx->slots[slot].id), slot, objectCtx->slots[slot].segment);
+    AutoObjectSlots_onObjectLoaded(set_id, ABS_ALT(id), slot, object);
+
+    id_slots->ids[shadow_index] = objectCtx->slots[slot].id;
+    objectCtx->slots[slot].id = id;
+    objectCtx->slots[slot].segment = object;
+}
+
+// Returns the active per-ID set if the given object context currently holds its window, or NULL otherwise.
+IdSlots* get_active_id_slots(ObjectContext* objectCtx) {
+    if (auto_slot_loading_enabled && slot_load_id_stack.play != NULL && objectCtx == &slot_load_id_stack.play->objectCtx) {
+        return slot_load_id_stack.sets[slot_load_id_stack.depth - 1];
+    }
+    return NULL;
+}
+
+// Gives the active ID its own copy of its set before the set's shadow entries get modified.
+IdSlots* detach_active_id_slots(void) {
+    s32 top = slot_load_id_stack.depth - 1;
+    return detach_id_slots(slot_load_id_stack.ids[top], slot_load_id_stack.sets[top]);
+}
+
+// Resolves an object from a room's object list whose loading was deferred until its first lookup.
+void resolve_deferred_slot(ObjectContext* objectCtx, s32 slot) {
+    s16 objectId = ABS_ALT(objectCtx->slots[slot].id);
+
+    objectCtx->slots[slot].segment = object_cache_get_segment(objectId);
+    loaded_slots_dirty = true;
+    AutoObjectSlots_onObjectLoaded(get_loaded_set_id(objectCtx), objectId, slot, objectCtx->slots[slot].segment);
+}
+
+s32 get_object_slot(ObjectContext* objectCtx, s16 objectId) {
     s32 i;
+    IdSlots* active_id_slots;
     // recomp_printf("Getting slot for object 0x%04X\n", objectId);
 
+    // @mod Stamp the object for the least recently used eviction policy, whether or not it's in the window yet.
+    if (slot_eviction_policy == SLOT_EVICTION_LEAST_RECENTLY_USED && objectId > 0 && objectId < OBJECT_ID_MAX) {
+        object_last_lookup[objectId] = ++object_lookup_clock;
+    }
+
     for (i = 0; i < objectCtx->numEntries; i++) {
         if (ABS_ALT(objectCtx->slots[i].id) == objectId) {
             // recomp_printf("  Found in slot %d\n", i);
+            slot_metrics.lookupHits++;
+            // @mod Keep track of which sets still use the promoted persistent objects.
+            if (i < objectCtx->numPersistentEntries && shared_prefix_enabled) {
+                shared_prefix_record_use(objectId);
+            }
+            // @mod Resolve the object now if it came from a room's object list and was deferred.
+            if (objectCtx->slots[i].segment == NULL) {
+                resolve_deferred_slot(objectCtx, i);
+            }
             return i;
         }
     }
 
-    // @mod Search for an empty slot and load the object if auto slot loading is currently enabled.
-    // if (auto_slot_loading_enabled) {
+    slot_metrics.lookupMisses++;
+
+    // @mod If this is the hook of an actor ID that was treated as trivial, load the ID's own set instead of growing the
+    // global set. The window starts out as a copy of the global set, so there's no need to search it again.
+    promote_trivial_hook_id(objectCtx, objectId);
+
+    // @mod Check the active set's shadow entries, and swap the object into the window if it's found there.
+    active_id_slots = get_active_id_slots(objectCtx);
+    if (active_id_slots != NULL) {
+        for (i = OBJECT_SLOT_COUNT; i < OBJECT_SLOT_COUNT + active_id_slots->numShadowEntries; i++) {
+            if (ABS_ALT(active_id_slots->ids[i]) == objectId) {
+                active_id_slots = detach_active_id_slots();
+                loaded_slots_dirty = true;
+                s32 slot = pick_victim_slot(slot_load_id_stack.play, get_actor_stack_top(&slot_load_id_stack), active_id_slots);
+                if (slot != OBJECT_SLOT_NONE) {
+                    swap_shadow_entry(objectCtx, active_id_slots, i, slot);
+                    slot_metrics.shadowSwaps++;
+                    if (objectCtx->slots[slot].segment == NULL) {
+                        resolve_deferred_slot(objectCtx, slot);
+                    }
+                    return slot;
+                }
+                break;
+            }
+        }
+    }
+
+    // @mod Search for an empty slot and load the object, unless the auto load scope leaves the global set alone.
+    if (slot_auto_load_scope == SLOT_AUTO_LOAD_EVERYWHERE || active_id_slots != NULL) {
         if (objectCtx->numEntries < OBJECT_SLOT_COUNT) {
             int slot = objectCtx->numEntries;
-            recomp_printf("Auto loading object %-24s 0x%04X into slot %d\n", get_obj_define_string(objectId), objectId, i);
+            SLOT_LOG(SLOT_LOG_INFO, "Auto loading object %-24s 0x%04X into slot %d\n", get_obj_define_string(objectId),
+                     objectId, slot);
             objectCtx->numEntries++;
             objectCtx->slots[slot].id = objectId;
-            objectCtx->slots[slot].segment = GlobalObjects_getGlobalObject(objectId);
+            loaded_slots_dirty = true;
+            slot_metrics.autoLoads++;
+            objectCtx->slots[slot].segment = object_cache_get_segment(objectId);
+            AutoObjectSlots_onObjectLoaded(get_loaded_set_id(objectCtx), objectId, slot, objectCtx->slots[slot].segment);
+            // @mod Appends to the global set stay for the rest of the scene, so keep track of what caused them.
+            if (get_loaded_set_id(objectCtx) == AUTO_OBJECT_SLOTS_GLOBAL_SET) {
+                pollution_record_global_append(objectId, get_hook_set_id());
+            } else {
+                // @mod The ID's own set changed, e.g. for a trivial ID that got pushed because it spawned inside another
+                // hook, so its later top-level hooks have to load the set too.
+                mark_id_needs_set(get_loaded_set_id(objectCtx));
+            }
             // print_context(objectCtx);
             return slot;
         }
-    // }
+    }
+
+    // @mod The window is full, so move one of its objects into the active set's shadow entries to make room.
+    if (active_id_slots != NULL && slot_eviction_policy != SLOT_EVICTION_OFF &&
+        active_id_slots->numShadowEntries < ID_SLOT_CAPACITY - OBJECT_SLOT_COUNT) {
+        active_id_slots = detach_active_id_slots();
+        loaded_slots_dirty = true;
+        s32 slot = pick_victim_slot(slot_load_id_stack.play, get_actor_stack_top(&slot_load_id_stack), active_id_slots);
+        if (slot != OBJECT_SLOT_NONE) {
+            s32 shadow_index = OBJECT_SLOT_COUNT + active_id_slots->numShadowEntries;
+            active_id_slots->numShadowEntries++;
+            active_id_slots->ids[shadow_index] = objectCtx->slots[slot].id;
+            SLOT_LOG(SLOT_LOG_INFO, "Auto loading object %-24s 0x%04X into slot %d, moved 0x%04X to the shadow slots\n",
+                     get_obj_define_string(objectId), objectId, slot, ABS_ALT(objectCtx->slots[slot].id));
+            AutoObjectSlots_onObjectEvicted(get_loaded_set_id(objectCtx), ABS_ALT(objectCtx->slots[slot].id), slot,
+                                            objectCtx->slots[slot].segment);
+            objectCtx->slots[slot].id = objectId;
+            objectCtx->slots[slot].segment = object_cache_get_segment(objectId);
+            slot_metrics.evictions++;
+            slot_metrics.autoLoads++;
+            AutoObjectSlots_onObjectLoaded(get_loaded_set_id(objectCtx), objectId, slot, objectCtx->slots[slot].segment);
+            return slot;
+        }
+    }
 
     // recomp_printf("  Not found\n");
     return OBJECT_SLOT_NONE;
 }
 
-// Patched to immediately load objects using global objects instead of deferring them to a later point.
+// Patched to load objects if the slot wasn't found and a free space exists.
+RECOMP_PATCH s32 Object_GetSlot(ObjectContext* objectCtx, s16 objectId) {
+    u32 start;
+    s32 slot;
+
+    // @mod The lookup itself is in get_object_slot so that it can be timed as a whole.
+    if (!profiler_enabled) {
+        return get_object_slot(objectCtx, objectId);
+    }
+
+    start = profiler_now();
+    slot = get_object_slot(objectCtx, objectId);
+    profiler_record_lookup(get_hook_set_id(), objectId, start);
+    return slot;
+}
+
+bool id_slots_has_object(IdSlots* id_slots, s16 objectId) {
+    for (s32 i = 0; i < id_slots->numEntries; i++) {
+        if (ABS_ALT(id_slots->ids[i]) == objectId) {
+            return true;
+        }
+    }
+    for (s32 i = OBJECT_SLOT_COUNT; i < OBJECT_SLOT_COUNT + id_slots->numShadowEntries; i++) {
+        if (ABS_ALT(id_slots->ids[i]) == objectId) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Adds objects to an ID's set, detaching and sharing the set only once for all of them. Objects that don't fit in the
+// window go into the shadow entries. Returns the number of the given objects that are in the set afterwards.
+u32 id_slots_add_objects(SlotSetId id, s16* objectIds, u32 count) {
+    IdSlots* id_slots = get_id_slots(id);
+    ObjectContext* objectCtx = NULL;
+    s32 loaded_index;
+    u32 num_added = 0;
+    u32 num_in_set = 0;
+
+    if (id_slots == NULL) {
+        return 0;
+    }
+
+    // If the set is the one in the object context, wherever it is in the stack, the window is its up to date copy and
+    // gets written back over the set when it's unloaded. Bring the set up to date first and reload the window from it
+    // afterwards.
+    loaded_index = get_loaded_set_index(&slot_load_id_stack, slot_load_id_stack.depth);
+    if (loaded_index != -1 && slot_load_id_stack.ids[loaded_index] == id) {
+        objectCtx = &slot_load_id_stack.play->objectCtx;
+        if (loaded_slots_dirty) {
+            id_slots = write_back_slots(objectCtx, id, id_slots);
+            loaded_slots_dirty = false;
+        }
+    }
+
+    for (u32 n = 0; n < count; n++) {
+        s16 objectId = objectIds[n];
+        s32 index;
+
+        if (id_slots_has_object(id_slots, objectId)) {
+            num_in_set++;
+            continue;
+        }
+        if (id_slots->numEntries >= OBJECT_SLOT_COUNT &&
+            id_slots->numShadowEntries >= ID_SLOT_CAPACITY - OBJECT_SLOT_COUNT) {
+            continue;
+        }
+
+        if (num_added == 0) {
+            mark_id_needs_set(id);
+            id_slots = detach_id_slots(id, id_slots);
+        }
+        if (id_slots->numEntries < OBJECT_SLOT_COUNT) {
+            index = id_slots->numEntries++;
+        } else {
+            index = OBJECT_SLOT_COUNT + id_slots->numShadowEntries++;
+        }
+
+        id_slots->ids[index] = objectId;
+        num_added++;
+        num_in_set++;
+        AutoObjectSlots_onObjectLoaded(id, objectId, index < OBJECT_SLOT_COUNT ? index : OBJECT_SLOT_NONE,
+                                       object_cache_get_segment(objectId));
+    }
+
+    if (num_added != 0) {
+        id_slots = share_id_slots(id, id_slots);
+        if (objectCtx != NULL) {
+            load_slots_impl(objectCtx, id_slots);
+        }
+        if (slot_verification_enabled) {
+            verify_set_changed(id);
+        }
+    }
+    return num_in_set;
+}
+
+bool id_slots_add_object(SlotSetId id, s16 objectId) {
+    return id_slots_add_objects(id, &objectId, 1) != 0;
+}
+
+// Patched to immediately load objects using global objects instead of deferring them to a later point, or to defer them
+// until they're looked up if lazy scene object loading is enabled.
 RECOMP_PATCH void* func_8012F73C(ObjectContext* objectCtx, s32 slot, s16 id) {
+    // @mod Vanilla doesn't bound the room's object list, which only fit next to the vanilla persistent objects. Objects
+    // that don't fit anymore are dropped and get loaded on their first lookup if there's room by then.
+    if (slot >= OBJECT_SLOT_COUNT) {
+        SLOT_LOG(SLOT_LOG_WARNINGS, "Warning: No slot left for room object %s 0x%04X\n", get_obj_define_string(id), id);
+        return NULL;
+    }
+
+    // @mod Notify listeners if this replaces a different object from the previous room.
+    if (slot < objectCtx->numEntries && objectCtx->slots[slot].id != 0 && ABS_ALT(objectCtx->slots[slot].id) != id) {
+        AutoObjectSlots_onObjectInvalidated(get_loaded_set_id(objectCtx), ABS_ALT(objectCtx->slots[slot].id), slot,
+                                            objectCtx->slots[slot].segment);
+    }
+
     objectCtx->slots[slot].id = id;
     objectCtx->slots[slot].dmaReq.vromAddr = 0;
-    objectCtx->slots[slot].segment = GlobalObjects_getGlobalObject(id);
+    loaded_slots_dirty = true;
+    shared_prefix_record_room_object(id);
+
+    // @mod In lazy mode, only record the object here and leave resolving it to its first lookup in Object_GetSlot.
+    if (lazy_scene_objects_enabled) {
+        objectCtx->slots[slot].segment = NULL;
+        return NULL;
+    }
+
+    objectCtx->slots[slot].segment = object_cache_get_segment(id);
+    AutoObjectSlots_onObjectLoaded(get_loaded_set_id(objectCtx), id, slot, objectCtx->slots[slot].segment);
 
     return NULL;
 }
+
+ObjectContext* object_list_ctx = NULL;
+
+RECOMP_HOOK("Scene_CommandObjectList") void on_command_object_list(PlayState* play, SceneCmd* cmd) {
+    object_list_ctx = &play->objectCtx;
+    shared_prefix_record_room_list(play->sceneId, cmd->objectList.num);
+}
+
+// Vanilla sets numEntries to the end of the room's object list, which can be past the last slot if the persistent
+// objects were extended, see shared_prefix.c and func_8012F73C.
+RECOMP_HOOK_RETURN("Scene_CommandObjectList") void after_command_object_list() {
+    if (object_list_ctx != NULL && object_list_ctx->numEntries > OBJECT_SLOT_COUNT) {
+        object_list_ctx->numEntries = OBJECT_SLOT_COUNT;
+    }
+    object_list_ctx = NULL;
+}
+
+// Patched to skip checking the slots for pending DMAs. Vanilla marks slots that are still loading with a negative ID and
+// polls them here every frame, but every slot is loaded (or deferred to its first lookup) as soon as it's assigned, so
+// there's never anything to poll.
+RECOMP_PATCH void Object_UpdateEntries(ObjectContext* objectCtx) {
+}
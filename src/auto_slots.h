@@ -0,0 +1,114 @@
+#ifndef __AUTO_SLOTS_H__
+#define __AUTO_SLOTS_H__
+
+#include "global.h"
+
+// Must not be changed, needs to match the size of ObjectContext's slots array.
+#define OBJECT_SLOT_COUNT 35
+
+// Per-ID sets can hold more objects than fit in ObjectContext's slots. The first OBJECT_SLOT_COUNT entries are the
+// window that gets loaded into the object context, and the entries after them are shadow entries that get swapped into
+// the window when they're looked up.
+#define ID_SLOT_CAPACITY 64
+
+// Identifies a slot set. This is the actor ID, which may be outside the vanilla range for actors added by other mods.
+typedef s32 SlotSetId;
+
+#define SLOT_SET_ID_NONE -1
+
+// Actor IDs with a params variant mask have a set per variant, identified by the actor ID in the low 16 bits and the
+// variant key in the bits above it. Variant zero is the plain actor ID.
+#define SLOT_SET_ID(actorId, variant) ((SlotSetId)(((variant) << 16) | ((actorId) & 0xFFFF)))
+#define SLOT_SET_ACTOR_ID(id) ((s16)((id) & 0xFFFF))
+
+// Soft sprite effects get a slot set per effect type, identified by an ID past the range used for actor IDs.
+#define EFFECT_SLOT_SET_ID_BASE 0x7F00
+#define EFFECT_SLOT_SET_ID(type) (EFFECT_SLOT_SET_ID_BASE + (type))
+
+// Returns true if the given set ID is an effect type's and an effect of that type is alive, see effect_slots.c.
+bool effect_set_is_live(SlotSetId id);
+
+// Sets are shared between every actor ID whose set has the same contents, see auto_slots.c.
+typedef struct {
+    // Number of actor IDs bound to this set.
+    u16 refCount;
+    // Whether this set is the one registered under its content hash. Only registered sets get shared with other IDs.
+    bool interned;
+    u32 hash;
+    u8 numEntries;
+    // numPersistentEntries is inherited from the global object context.
+    u8 numShadowEntries;
+    // Round robin cursor over the non-persistent window slots, used to pick which one gets swapped out.
+    u8 nextVictimSlot;
+    // Total size of the objects in this set, updated whenever the set is shared.
+    u32 numBytes;
+    // Segments aren't stored in sets, they come from the object table in object_cache.c.
+    s16 ids[ID_SLOT_CAPACITY];
+} IdSlots;
+
+// Actor ID reported in slot events for the global object context's set.
+#define AUTO_OBJECT_SLOTS_GLOBAL_SET -1
+
+// Slot lifecycle events, declared in auto_slots.c.
+void AutoObjectSlots_onObjectLoaded(s16 actorId, s16 objectId, s32 slot, void* segment);
+void AutoObjectSlots_onObjectEvicted(s16 actorId, s16 objectId, s32 slot, void* segment);
+void AutoObjectSlots_onObjectInvalidated(s16 actorId, s16 objectId, s32 slot, void* segment);
+
+// Whether objects from a room's object list are only resolved the first time they're looked up, instead of when the
+// room loads.
+extern bool lazy_scene_objects_enabled;
+
+// Whether the per-ID sets have been set up for the current scene.
+extern bool slot_sets_initialized;
+
+// Changes whenever an ID is bound to a different set or a set's contents change.
+extern u32 slot_sets_generation;
+
+// Loads the given ID's set for the duration of a hooked function, and restores the previous set when it returns.
+void on_enter_set_hook(SlotSetId id, PlayState* play);
+void on_exit_set_hook(void);
+// Same as on_enter_set_hook, for an ID whose set the enclosing hook has loaded already.
+void on_enter_loaded_set_hook(SlotSetId id, PlayState* play);
+// Same as on_enter_set_hook, for a hook that doesn't need the ID's set at all.
+void on_enter_unloaded_set_hook(SlotSetId id, PlayState* play);
+// Returns the set ID of the innermost running actor or effect hook, or AUTO_OBJECT_SLOTS_GLOBAL_SET outside of any hook.
+SlotSetId get_hook_set_id(void);
+// Returns the guest address of the actor Draw or Update function whose hook is innermost, or 0 outside of those hooks.
+u32 get_hook_caller(void);
+
+// Set right before a batch spawn calls Actor_SpawnAsChildAndCutscene, so that the spawn hook skips switching sets.
+extern bool batch_spawn_pending;
+
+// Returns the set ID for an actor with the given ID and params, see variant_slots.c.
+SlotSetId get_spawn_set_id(s16 actorId, s16 params);
+// Returns the set ID the given actor was spawned with.
+SlotSetId get_actor_set_id(Actor* actor);
+
+// Adds an object to the given actor ID's set if it isn't in it already. Returns false if the set is full.
+bool id_slots_add_object(SlotSetId id, s16 objectId);
+// Same as id_slots_add_object for several objects at once. Returns the number of them that are in the set afterwards.
+u32 id_slots_add_objects(SlotSetId id, s16* objectIds, u32 count);
+
+// Objects registered through the API for any actor ID.
+u32 get_num_registered_objects(void);
+s16 get_registered_object_id(u32 index);
+
+// Applies the objects registered through the API to the freshly reset per-ID sets.
+void apply_registered_actor_objects(void);
+// Applies the objects registered for an actor ID to one of its variant sets.
+void apply_registered_variant_objects(SlotSetId id);
+
+// Writes the ID, entry counts and object bytes of up to max_sets known sets into out as three words each, see metrics.c.
+// Returns the total number of known sets.
+u32 get_slot_set_sizes(u32* out, u32 max_sets);
+// Returns the number of distinct sets that are shared between IDs.
+u32 get_num_shared_slot_sets(void);
+
+// Marks every object that's in the object context, on the load stack, or in the set of a live actor or of an effect type.
+// Objects that aren't marked aren't in use and can be freed, see object_cache_enforce_budget.
+void mark_referenced_objects(PlayState* play, bool* referenced);
+
+const char *get_actor_define_string(SlotSetId id);
+const char *get_obj_define_string(s16 objectId);
+
+#endif
@@ -0,0 +1,124 @@
+#include "modding.h"
+#include "global.h"
+#include "recomputils.h"
+
+#include "auto_slots.h"
+#include "object_cache.h"
+#include "slot_config.h"
+
+// Spawning many actors at once through Actor_SpawnAsChildAndCutscene switches sets and logs for every single actor.
+// Batched spawns group the actors by set instead, so each set is loaded once, the objects of every group are resolved
+// together up front, and the actors of a group are spawned back to back with their set already loaded.
+
+// Must match AutoObjectSlotsSpawnInfo in include/auto_object_slots_api.h.
+typedef struct {
+    /* 0x00 */ f32 x;
+    /* 0x04 */ f32 y;
+    /* 0x08 */ f32 z;
+    /* 0x0C */ s16 rotX;
+    /* 0x0E */ s16 rotY;
+    /* 0x10 */ s16 rotZ;
+    /* 0x12 */ s16 id;
+    /* 0x14 */ s32 params;
+    /* 0x18 */ u32 csId;
+    /* 0x1C */ u32 halfDaysBits;
+    /* 0x20 */ Actor* parent;
+} SpawnInfo; // size = 0x24
+
+// The object each actor ID was last seen using, see scene_prefetch.c.
+extern s16 learned_actor_object_ids[ACTOR_ID_MAX];
+
+typedef struct {
+    SlotSetId setId;
+    u32 index;
+} BatchEntry;
+
+// Sorts the entries by set ID. Stable, so actors within a group spawn in the order they were given.
+void sort_batch_entries(BatchEntry* entries, u32 count) {
+    for (u32 i = 1; i < count; i++) {
+        BatchEntry entry = entries[i];
+        u32 j = i;
+
+        while (j > 0 && entries[j - 1].setId > entry.setId) {
+            entries[j] = entries[j - 1];
+            j--;
+        }
+        entries[j] = entry;
+    }
+}
+
+// Spawns the given actors, grouped by the set they use. Actors of the same group are spawned in the order given, but
+// groups may be spawned in a different order than their actors appear in `spawns`. If `outActors` isn't NULL, it receives
+// the spawned actor (or NULL) for each entry of `spawns`. Returns the number of actors that were spawned.
+RECOMP_EXPORT u32 AutoObjectSlots_spawnActors(PlayState* play, SpawnInfo* spawns, u32 count, Actor** outActors) {
+    BatchEntry* entries;
+    s16* object_ids;
+    u32 num_object_ids = 0;
+    u32 num_spawned = 0;
+    u32 group_start = 0;
+
+    if (play == NULL || count == 0) {
+        return 0;
+    }
+
+    entries = recomp_alloc(count * sizeof(BatchEntry));
+    object_ids = recomp_alloc(count * sizeof(s16));
+    for (u32 i = 0; i < count; i++) {
+        s16 actor_id = spawns[i].id;
+
+        entries[i].setId = get_spawn_set_id(actor_id, spawns[i].params);
+        entries[i].index = i;
+        if (actor_id >= 0 && actor_id < ACTOR_ID_MAX && learned_actor_object_ids[actor_id] != 0) {
+            object_ids[num_object_ids++] = learned_actor_object_ids[actor_id] - 1;
+        }
+    }
+    sort_batch_entries(entries, count);
+
+    // Decompress every group's objects in one go before any set is loaded.
+    object_cache_prefetch(object_ids, num_object_ids);
+    object_cache_prefetch_finish();
+
+    while (group_start < count) {
+        SlotSetId set_id = entries[group_start].setId;
+        s16 actor_id = SLOT_SET_ACTOR_ID(set_id);
+        u32 group_end = group_start;
+
+        while (group_end < count && entries[group_end].setId == set_id) {
+            group_end++;
+        }
+
+        SLOT_LOG_ID(SLOT_LOG_INFO, set_id, "Batch spawning %3d actors %-20s (ID: 0x%04X)\n", group_end - group_start,
+                    get_actor_define_string(actor_id), actor_id);
+
+        on_enter_set_hook(set_id, play);
+        // Look the group's object up once, so that a miss is resolved here rather than during the first actor's init.
+        if (actor_id >= 0 && actor_id < ACTOR_ID_MAX && learned_actor_object_ids[actor_id] != 0) {
+            Object_GetSlot(&play->objectCtx, learned_actor_object_ids[actor_id] - 1);
+        }
+
+        for (u32 i = group_start; i < group_end; i++) {
+            SpawnInfo* spawn = &spawns[entries[i].index];
+            Actor* actor;
+
+            batch_spawn_pending = true;
+            actor = Actor_SpawnAsChildAndCutscene(&play->actorCtx, play, spawn->id, spawn->x, spawn->y, spawn->z,
+                                                  spawn->rotX, spawn->rotY, spawn->rotZ, spawn->params, spawn->csId,
+                                                  spawn->halfDaysBits, spawn->parent);
+            batch_spawn_pending = false;
+
+            if (actor != NULL) {
+                num_spawned++;
+            }
+            if (outActors != NULL) {
+                outActors[entries[i].index] = actor;
+            }
+        }
+        on_exit_set_hook();
+
+        group_start = group_end;
+    }
+
+    recomp_free(object_ids);
+    recomp_free(entries);
+    return num_spawned;
+}
@@ -0,0 +1,52 @@
+#include "modding.h"
+#include "global.h"
+
+#include "auto_slots.h"
+
+// Soft sprite effects look up their objects when they're spawned and keep using the resulting slots while they're
+// updated and drawn, which happens outside of any actor's hooks. Without a set of their own, the objects they need end
+// up in the global set and use up the slots that actor spawns depend on.
+// Each effect type gets its own set instead, loaded around every entry point that can look up or use its slots. The
+// sets of effect types that need the same objects are shared, so switching between them is free. Like actor IDs, effect
+// types start out trivial and keep running with the global set until they need an object it doesn't have.
+
+extern EffectSsInfo sEffectSsInfo;
+
+// Effects store the slots they looked up in their own instance data (e.g. rgObjectSlot), at a different place for every
+// effect type, so an evicted slot can't be remapped for them like an actor's objectSlot. Instead, none of an effect
+// type's slots are evicted while an effect of that type is alive.
+bool effect_set_is_live(SlotSetId id) {
+    if (id < EFFECT_SLOT_SET_ID_BASE || id >= EFFECT_SLOT_SET_ID_BASE + EFFECT_SS_TYPE_MAX) {
+        return false;
+    }
+    for (s32 i = 0; i < sEffectSsInfo.size; i++) {
+        if (sEffectSsInfo.dataTable[i].life > -1 && sEffectSsInfo.dataTable[i].type == id - EFFECT_SLOT_SET_ID_BASE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+RECOMP_HOOK("EffectSs_Spawn") void on_effect_spawn(PlayState* play, s32 type, s32 priority, void* initParams) {
+    on_enter_set_hook(EFFECT_SLOT_SET_ID(type), play);
+}
+
+RECOMP_HOOK_RETURN("EffectSs_Spawn") void after_effect_spawn() {
+    on_exit_set_hook();
+}
+
+RECOMP_HOOK("EffectSs_Update") void on_effect_update(PlayState* play, s32 index) {
+    on_enter_set_hook(EFFECT_SLOT_SET_ID(sEffectSsInfo.dataTable[index].type), play);
+}
+
+RECOMP_HOOK_RETURN("EffectSs_Update") void after_effect_update() {
+    on_exit_set_hook();
+}
+
+RECOMP_HOOK("EffectSs_Draw") void on_effect_draw(PlayState* play, s32 index) {
+    on_enter_set_hook(EFFECT_SLOT_SET_ID(sEffectSsInfo.dataTable[index].type), play);
+}
+
+RECOMP_HOOK_RETURN("EffectSs_Draw") void after_effect_draw() {
+    on_exit_set_hook();
+}
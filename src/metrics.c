@@ -0,0 +1,53 @@
+#include "modding.h"
+#include "global.h"
+#include "recomputils.h"
+
+#include "auto_slots.h"
+#include "metrics.h"
+#include "slot_config.h"
+#include "native_bridge.h"
+
+// Publishes the slot manager's counters to a shared memory region once per frame, so that they can be followed live
+// with tools/metrics_tail without adding logging to the game's hot paths. Off by default, since it calls into the
+// native library every frame.
+bool metrics_enabled = false;
+
+// Must match METRICS_MAX_SETS in native/metrics_layout.h.
+#define METRICS_MAX_SETS 1024
+
+SlotMetrics slot_metrics;
+
+// Three words per set: the set ID, then (numShadowEntries << 16) | numEntries, then the size of the set's objects.
+u32 metrics_set_sizes[METRICS_MAX_SETS * 3];
+
+bool metrics_opened = false;
+// Set once opening the region failed, so that it isn't retried (and warned about) every time gameplay starts.
+bool metrics_open_failed = false;
+
+RECOMP_HOOK("Play_Main") void metrics_on_play_main(GameState* thisx) {
+    u32 num_sets;
+
+    slot_metrics.frame++;
+    if (!metrics_enabled || metrics_open_failed) {
+        return;
+    }
+
+    if (!metrics_opened) {
+        if (!native_library_check("Metrics")) {
+            metrics_open_failed = true;
+            return;
+        }
+        if (!metrics_open()) {
+            SLOT_LOG(SLOT_LOG_WARNINGS, "Warning: Couldn't open the metrics shared memory region, disabling metrics\n");
+            metrics_open_failed = true;
+            return;
+        }
+        metrics_opened = true;
+    }
+
+    num_sets = get_slot_set_sizes(metrics_set_sizes, METRICS_MAX_SETS);
+    slot_metrics.numSets = num_sets;
+    slot_metrics.numSharedSets = get_num_shared_slot_sets();
+    metrics_publish((u32*)&slot_metrics, sizeof(SlotMetrics) / sizeof(u32), metrics_set_sizes,
+                    num_sets < METRICS_MAX_SETS ? num_sets : METRICS_MAX_SETS);
+}
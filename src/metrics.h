@@ -0,0 +1,38 @@
+#ifndef __METRICS_H__
+#define __METRICS_H__
+
+#include "global.h"
+
+// Whether the counters below are published to shared memory every frame, see metrics.c.
+extern bool metrics_enabled;
+
+// Slot manager counters. The counters are always kept, since they're only increments, and are published to the native
+// library's shared memory region when metrics are enabled. The field order must match METRICS_COUNTERS in
+// native/metrics_layout.h.
+typedef struct {
+    u32 frame;
+    // Sets loaded into the object context when entering a hook, and loads skipped because the set was already loaded.
+    u32 setLoads;
+    u32 setLoadsSkipped;
+    // Copies of a whole set between a set and the object context's window.
+    u32 windowCopies;
+    // Object lookups that found the object in the window, and lookups that had to look further.
+    u32 lookupHits;
+    u32 lookupMisses;
+    // Objects loaded into the window by a lookup, whether into a free slot or in place of an evicted object.
+    u32 autoLoads;
+    // Objects swapped between the window and the active set's shadow entries.
+    u32 shadowSwaps;
+    // Objects moved out of the window into the shadow entries to make room for a new object.
+    u32 evictions;
+    // Actor updates that didn't switch sets because the actor wasn't going to update.
+    u32 frozenSkips;
+    u32 stackDepth;
+    u32 maxStackDepth;
+    u32 numSets;
+    u32 numSharedSets;
+} SlotMetrics;
+
+extern SlotMetrics slot_metrics;
+
+#endif
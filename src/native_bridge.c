@@ -0,0 +1,59 @@
+#include "modding.h"
+#include "global.h"
+
+#include "auto_object_slots_native.h"
+#include "native_bridge.h"
+#include "slot_config.h"
+
+// The native library lives in a mod of its own (see native_mod/), which registers the library's functions here when it's
+// initialized. Every feature that needs the library is optional, so when that mod isn't installed, the functions below
+// just fail and the features are turned off with a warning the first time they're used.
+AutoObjectSlotsNativeFuncs native_funcs;
+bool native_library_available = false;
+
+RECOMP_EXPORT void AutoObjectSlots_registerNative(const AutoObjectSlotsNativeFuncs* funcs) {
+    native_funcs = *funcs;
+    native_library_available = true;
+}
+
+bool native_library_check(const char* feature) {
+    if (!native_library_available) {
+        SLOT_LOG(SLOT_LOG_WARNINGS, "Warning: %s needs the " AUTO_OBJECT_SLOTS_NATIVE_MOD_ID " mod, which isn't installed\n",
+                 feature);
+    }
+    return native_library_available;
+}
+
+s32 objcache_open(const char* save_path, u32 rom_hash) {
+    return native_library_available ? native_funcs.objcacheOpen(save_path, rom_hash) : 0;
+}
+
+s32 objcache_lookup(s16 object_id, void* dst, u32 size) {
+    return native_library_available ? native_funcs.objcacheLookup(object_id, dst, size) : 0;
+}
+
+s32 objcache_store(s16 object_id, const void* src, u32 size) {
+    return native_library_available ? native_funcs.objcacheStore(object_id, src, size) : 0;
+}
+
+u32 yaz0_batch_submit(void* jobs, u32 count) {
+    return native_library_available ? native_funcs.yaz0BatchSubmit(jobs, count) : 0;
+}
+
+u32 yaz0_batch_wait(u32 batch) {
+    return native_library_available ? native_funcs.yaz0BatchWait(batch) : 0;
+}
+
+u32 host_clock_ns(void) {
+    return native_library_available ? native_funcs.hostClockNs() : 0;
+}
+
+s32 metrics_open(void) {
+    return native_library_available ? native_funcs.metricsOpen() : 0;
+}
+
+void metrics_publish(const u32* counters, u32 num_counters, const u32* sets, u32 num_sets) {
+    if (native_library_available) {
+        native_funcs.metricsPublish(counters, num_counters, sets, num_sets);
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef __NATIVE_BRIDGE_H__
+#define __NATIVE_BRIDGE_H__
+
+#include "global.h"
+
+// Whether the optional native library mod has registered its functions, see native_bridge.c.
+extern bool native_library_available;
+
+// Returns true if the native library is available, and logs that the given feature needs it otherwise.
+bool native_library_check(const char* feature);
+
+// Native library functions. They fail (returning 0) when the native library isn't available.
+s32 objcache_open(const char* save_path, u32 rom_hash);
+s32 objcache_lookup(s16 object_id, void* dst, u32 size);
+s32 objcache_store(s16 object_id, const void* src, u32 size);
+u32 yaz0_batch_submit(void* jobs, u32 count);
+u32 yaz0_batch_wait(u32 batch);
+u32 host_clock_ns(void);
+s32 metrics_open(void);
+void metrics_publish(const u32* counters, u32 num_counters, const u32* sets, u32 num_sets);
+
+#endif
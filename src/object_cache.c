@@ -0,0 +1,489 @@
+#include "modding.h"
+#include "global.h"
+#include "recomputils.h"
+#include "recompdata.h"
+
+#include "globalobjects_api.h"
+#include "auto_slots.h"
+#include "object_cache.h"
+#include "slot_config.h"
+#include "metrics.h"
+#include "native_bridge.h"
+
+// Jobs passed to yaz0_batch_submit, must match the layout in native/yaz0_pool.c.
+typedef struct {
+    void* src;
+    u32 srcSize;
+    void* dst;
+    u32 dstSize;
+    s32 status;
+} Yaz0Job;
+
+// Off by default. When enabled, objects resolved by this mod are loaded into memory owned by this mod, with the
+// decompressed data coming from an on-disk cache when available instead of being decompressed from the ROM again.
+bool object_cache_enabled = false;
+
+typedef enum {
+    OBJECT_CACHE_CLOSED,
+    OBJECT_CACHE_OPEN,
+    OBJECT_CACHE_UNAVAILABLE,
+} ObjectCacheState;
+
+ObjectCacheState object_cache_state = OBJECT_CACHE_CLOSED;
+
+// The resolved segment of every object, indexed by object ID. Sets only store object IDs and get segments from here, so
+// each object is only resolved once no matter how many sets hold it. Objects loaded through the cache stay resident
+// until the memory budget below frees them, and objects resolved by GlobalObjects are retained up to the caps below.
+void* object_segments[OBJECT_ID_MAX];
+
+// Segments resolved by GlobalObjects are its memory, so retaining them here only saves resolving them again. Their
+// number and total size are capped, and the least recently used ones are dropped first once either cap is reached. A
+// dropped segment is simply resolved again the next time it's needed.
+#define RETAINED_OBJECTS_MAX 192
+#define RETAINED_OBJECT_BYTES_MAX (16 * 1024 * 1024)
+
+u32 num_retained_objects = 0;
+u32 retained_object_bytes = 0;
+
+// Objects loaded through the cache are counted against a memory budget, by the size of their file in the object table.
+// When the budget is exceeded, the objects that no set of a live actor or effect holds and that haven't been used for a
+// while are freed again, least recently used first, and get loaded again the next time they're looked up. Objects that
+// GlobalObjects resolved are counted in the total, but their memory isn't this mod's to free.
+// Budget in bytes, zero for no budget.
+u32 object_memory_budget = 0;
+
+// Objects have to go unused for this many frames before they can be evicted.
+#define OBJECT_COLD_FRAMES 200
+
+// Bytes of every object resolved so far, and of the ones in memory owned by this mod.
+u32 resident_object_bytes = 0;
+u32 owned_object_bytes = 0;
+
+// The allocation behind each object loaded through the cache, for freeing it again.
+void* object_allocations[OBJECT_ID_MAX];
+
+// The frame each object was last used on, see object_cache_get_segment.
+u32 object_last_used[OBJECT_ID_MAX];
+
+bool object_budget_warning_printed = false;
+
+// When nothing could be evicted, there's no point in scanning again until something changes: more objects get loaded,
+// sets change, or enough frames pass for objects that were used too recently to have gone cold.
+bool object_budget_scan_latched = false;
+u32 object_budget_scan_bytes;
+u32 object_budget_scan_generation;
+u32 object_budget_scan_frame;
+
+// Segments of objects with IDs past the vanilla range, e.g. ones added by other mods.
+U32ValueHashmapHandle modded_object_segments;
+
+// The current scene's persistent objects live in the object context's own memory, which gets reused for the next
+// scene's persistent objects. Their table entries are swapped out for the duration of the scene, and whatever was
+// resolved for them before is put back afterwards.
+s16 persistent_object_ids[OBJECT_SLOT_COUNT];
+void* replaced_object_segments[OBJECT_SLOT_COUNT];
+u32 num_persistent_object_ids = 0;
+
+RECOMP_CALLBACK("*", recomp_on_init) void object_cache_on_init() {
+    modded_object_segments = recomputil_create_u32_value_hashmap();
+}
+
+// Hashes the ROM header's checksums and the ROM locations of every object file so that a cache built from a different
+// ROM is discarded. The checksums cover the ROM's contents, the locations catch mods that move objects around.
+u32 compute_rom_hash(void) {
+    u32 rom_header[0x40 / sizeof(u32)] __attribute__((aligned(16)));
+    u32 hash = 0x811C9DC5;
+
+    // CRC1 and CRC2 are the words at 0x10 and 0x14 of the header.
+    DmaMgr_RequestSync(rom_header, 0, sizeof(rom_header));
+    hash = (hash ^ rom_header[4]) * 0x01000193;
+    hash = (hash ^ rom_header[5]) * 0x01000193;
+
+    for (s32 id = 0; id < OBJECT_ID_MAX; id++) {
+        u32 words[4] = { gObjectTable[id].vromStart, gObjectTable[id].vromEnd, 0, 0 };
+
+        if (gObjectTable[id].vromEnd != gObjectTable[id].vromStart) {
+            DmaEntry* entry = DmaMgr_FindDmaEntry(gObjectTable[id].vromStart);
+            if (entry != NULL) {
+                words[2] = entry->romStart;
+                words[3] = entry->romEnd;
+            }
+        }
+
+        for (s32 i = 0; i < ARRAY_COUNT(words); i++) {
+            hash = (hash ^ words[i]) * 0x01000193;
+        }
+    }
+
+    return hash;
+}
+
+bool object_cache_open(void) {
+    if (object_cache_state == OBJECT_CACHE_CLOSED) {
+        unsigned char* save_path;
+        u32 rom_hash;
+
+        if (!native_library_check("The object cache")) {
+            object_cache_state = OBJECT_CACHE_UNAVAILABLE;
+            return false;
+        }
+
+        save_path = recomp_get_save_file_path();
+        rom_hash = compute_rom_hash();
+
+        if (objcache_open((const char*)save_path, rom_hash)) {
+            SLOT_LOG(SLOT_LOG_INFO, "Opened object cache (ROM hash %08X)\n", rom_hash);
+            object_cache_state = OBJECT_CACHE_OPEN;
+        } else {
+            SLOT_LOG(SLOT_LOG_WARNINGS, "Warning: Failed to open the object cache, falling back to GlobalObjects\n");
+            object_cache_state = OBJECT_CACHE_UNAVAILABLE;
+        }
+        recomp_free(save_path);
+    }
+
+    return object_cache_state == OBJECT_CACHE_OPEN;
+}
+
+u32 object_cache_get_object_size(s16 id) {
+    if (id <= 0 || id >= OBJECT_ID_MAX) {
+        return 0;
+    }
+    return gObjectTable[id].vromEnd - gObjectTable[id].vromStart;
+}
+
+void* object_cache_alloc_segment(s16 id, size_t size) {
+    // recomp_alloc makes no alignment guarantees beyond 8 bytes, and object segments are expected to be 16-byte aligned.
+    // The unaligned pointer is kept for freeing the object if it gets evicted.
+    void* segment = recomp_alloc(size + 0xF);
+    if (segment == NULL) {
+        return NULL;
+    }
+    object_allocations[id] = segment;
+    owned_object_bytes += size;
+    return (void*)ALIGN16((uintptr_t)segment);
+}
+
+bool is_persistent_object(s16 id);
+
+// Drops the least recently used retained segments until one of the given size fits in the caps.
+void trim_retained_objects(u32 size) {
+    while (num_retained_objects != 0 &&
+           (num_retained_objects >= RETAINED_OBJECTS_MAX || retained_object_bytes + size > RETAINED_OBJECT_BYTES_MAX)) {
+        s16 oldest = 0;
+
+        for (s16 id = 1; id < OBJECT_ID_MAX; id++) {
+            if (object_segments[id] != NULL && object_allocations[id] == NULL && !is_persistent_object(id) &&
+                (oldest == 0 || object_last_used[id] < object_last_used[oldest])) {
+                oldest = id;
+            }
+        }
+        if (oldest == 0) {
+            break;
+        }
+
+        object_segments[oldest] = NULL;
+        num_retained_objects--;
+        retained_object_bytes -= object_cache_get_object_size(oldest);
+        resident_object_bytes -= object_cache_get_object_size(oldest);
+    }
+}
+
+void store_object_segment(s16 id, void* segment) {
+    if (object_segments[id] == NULL && segment != NULL) {
+        u32 size = object_cache_get_object_size(id);
+
+        if (object_allocations[id] == NULL) {
+            trim_retained_objects(size);
+            num_retained_objects++;
+            retained_object_bytes += size;
+        }
+        resident_object_bytes += size;
+    }
+    object_segments[id] = segment;
+}
+
+void* object_cache_load(s16 id) {
+    size_t size = gObjectTable[id].vromEnd - gObjectTable[id].vromStart;
+    void* segment;
+
+    if (size == 0) {
+        return NULL;
+    }
+
+    segment = object_cache_alloc_segment(id, size);
+    if (segment == NULL) {
+        return NULL;
+    }
+
+    if (!objcache_lookup(id, segment, size)) {
+        DmaMgr_RequestSync(segment, gObjectTable[id].vromStart, size);
+        objcache_store(id, segment, size);
+    }
+
+    return segment;
+}
+
+// Prefetching reads the compressed object files from the ROM on the game thread and hands them to the native worker
+// pool, which decompresses them across the host's cores. The finished objects are collected the first time one of
+// them is needed, or at the latest when the scene commands that requested them are done executing.
+#define PREFETCH_MAX_OBJECTS 256
+
+bool object_prefetch_enabled = true;
+
+Yaz0Job prefetch_jobs[PREFETCH_MAX_OBJECTS];
+s16 prefetch_ids[PREFETCH_MAX_OBJECTS];
+u32 prefetch_num_jobs = 0;
+u32 prefetch_batch = 0;
+
+bool is_prefetch_queued(s16 id) {
+    for (u32 i = 0; i < prefetch_num_jobs; i++) {
+        if (prefetch_ids[i] == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void object_cache_prefetch(s16* ids, s32 count) {
+    if (!object_cache_enabled || !object_prefetch_enabled || !object_cache_open()) {
+        return;
+    }
+
+    // Only one batch is in flight at a time.
+    object_cache_prefetch_finish();
+
+    for (s32 i = 0; i < count && prefetch_num_jobs < PREFETCH_MAX_OBJECTS; i++) {
+        s16 id = ids[i];
+        size_t size;
+        void* segment;
+        DmaEntry* entry;
+        void* src;
+
+        if (id <= 0 || id >= OBJECT_ID_MAX || object_segments[id] != NULL || is_prefetch_queued(id)) {
+            continue;
+        }
+
+        size = gObjectTable[id].vromEnd - gObjectTable[id].vromStart;
+        if (size == 0) {
+            continue;
+        }
+
+        segment = object_cache_alloc_segment(id, size);
+        if (segment == NULL) {
+            continue;
+        }
+
+        if (objcache_lookup(id, segment, size)) {
+            store_object_segment(id, segment);
+            continue;
+        }
+
+        // Uncompressed files don't need any decompression, so load them directly.
+        entry = DmaMgr_FindDmaEntry(gObjectTable[id].vromStart);
+        src = NULL;
+        if (entry != NULL && entry->romEnd != 0 && entry->vromStart == gObjectTable[id].vromStart) {
+            src = recomp_alloc(entry->romEnd - entry->romStart);
+        }
+        if (src == NULL) {
+            DmaMgr_RequestSync(segment, gObjectTable[id].vromStart, size);
+            objcache_store(id, segment, size);
+            store_object_segment(id, segment);
+            continue;
+        }
+
+        DmaMgr_DmaRomToRam(entry->romStart, src, entry->romEnd - entry->romStart);
+        prefetch_ids[prefetch_num_jobs] = id;
+        prefetch_jobs[prefetch_num_jobs].src = src;
+        prefetch_jobs[prefetch_num_jobs].srcSize = entry->romEnd - entry->romStart;
+        prefetch_jobs[prefetch_num_jobs].dst = segment;
+        prefetch_jobs[prefetch_num_jobs].dstSize = size;
+        prefetch_jobs[prefetch_num_jobs].status = 0;
+        prefetch_num_jobs++;
+    }
+
+    if (prefetch_num_jobs != 0) {
+        prefetch_batch = yaz0_batch_submit(prefetch_jobs, prefetch_num_jobs);
+        // If the batch couldn't be queued, finishing it will load every object synchronously instead.
+        if (prefetch_batch == 0) {
+            object_cache_prefetch_finish();
+        }
+    }
+}
+
+void object_cache_prefetch_finish(void) {
+    if (prefetch_num_jobs == 0) {
+        return;
+    }
+
+    if (prefetch_batch != 0) {
+        yaz0_batch_wait(prefetch_batch);
+        prefetch_batch = 0;
+    }
+
+    for (u32 i = 0; i < prefetch_num_jobs; i++) {
+        Yaz0Job* job = &prefetch_jobs[i];
+        s16 id = prefetch_ids[i];
+
+        if (!job->status) {
+            SLOT_LOG(SLOT_LOG_WARNINGS, "Warning: Failed to decompress object %04X in parallel, loading it directly\n", id);
+            DmaMgr_RequestSync(job->dst, gObjectTable[id].vromStart, job->dstSize);
+        }
+        objcache_store(id, job->dst, job->dstSize);
+        store_object_segment(id, job->dst);
+        recomp_free(job->src);
+    }
+
+    prefetch_num_jobs = 0;
+}
+
+void* object_cache_peek_segment(s16 id) {
+    unsigned long segment;
+
+    if (id > 0 && id < OBJECT_ID_MAX) {
+        object_last_used[id] = slot_metrics.frame;
+        return object_segments[id];
+    }
+    if (id >= OBJECT_ID_MAX && recomputil_u32_value_hashmap_get(modded_object_segments, (u32)id, &segment)) {
+        return (void*)segment;
+    }
+    return NULL;
+}
+
+void* object_cache_get_segment(s16 id) {
+    void* segment;
+
+    if (id <= 0) {
+        return GlobalObjects_getGlobalObject(id);
+    }
+    if (id >= OBJECT_ID_MAX) {
+        segment = object_cache_peek_segment(id);
+        if (segment == NULL) {
+            segment = GlobalObjects_getGlobalObject(id);
+            if (segment != NULL) {
+                recomputil_u32_value_hashmap_insert(modded_object_segments, (u32)id, (unsigned long)segment);
+            }
+        }
+        return segment;
+    }
+    object_last_used[id] = slot_metrics.frame;
+    if (object_segments[id] != NULL) {
+        return object_segments[id];
+    }
+
+    if (object_cache_enabled && object_cache_open()) {
+        // The object may be part of the batch that's currently being decompressed.
+        object_cache_prefetch_finish();
+        if (object_segments[id] == NULL) {
+            store_object_segment(id, object_cache_load(id));
+        }
+        if (object_segments[id] != NULL) {
+            return object_segments[id];
+        }
+    }
+
+    store_object_segment(id, GlobalObjects_getGlobalObject(id));
+    return object_segments[id];
+}
+
+void object_cache_set_persistent_segments(ObjectContext* objectCtx) {
+    for (u32 i = 0; i < num_persistent_object_ids; i++) {
+        object_segments[persistent_object_ids[i]] = replaced_object_segments[i];
+    }
+    num_persistent_object_ids = 0;
+
+    for (s32 slot = 0; slot < objectCtx->numPersistentEntries; slot++) {
+        s16 id = ABS_ALT(objectCtx->slots[slot].id);
+        if (id > 0 && id < OBJECT_ID_MAX) {
+            persistent_object_ids[num_persistent_object_ids] = id;
+            replaced_object_segments[num_persistent_object_ids] = object_segments[id];
+            num_persistent_object_ids++;
+            object_segments[id] = objectCtx->slots[slot].segment;
+        }
+    }
+}
+
+bool is_persistent_object(s16 id) {
+    for (u32 i = 0; i < num_persistent_object_ids; i++) {
+        if (persistent_object_ids[i] == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void evict_object(s16 id) {
+    u32 size = object_cache_get_object_size(id);
+
+    recomp_free(object_allocations[id]);
+    object_allocations[id] = NULL;
+    object_segments[id] = NULL;
+    owned_object_bytes -= size;
+    resident_object_bytes -= size;
+}
+
+// Frees cold objects, least recently used first, until the objects owned by this mod fit in the budget again.
+void object_cache_enforce_budget(PlayState* play) {
+    static bool referenced[OBJECT_ID_MAX];
+    u32 num_evicted = 0;
+    u32 evicted_bytes = 0;
+
+    if (object_memory_budget == 0 || owned_object_bytes <= object_memory_budget) {
+        object_budget_warning_printed = false;
+        object_budget_scan_latched = false;
+        return;
+    }
+    if (object_budget_scan_latched && owned_object_bytes == object_budget_scan_bytes &&
+        slot_sets_generation == object_budget_scan_generation &&
+        slot_metrics.frame - object_budget_scan_frame < OBJECT_COLD_FRAMES) {
+        return;
+    }
+
+    // Objects still being decompressed can't be freed, so let them finish first.
+    object_cache_prefetch_finish();
+    Lib_MemSet(referenced, 0, sizeof(referenced));
+    mark_referenced_objects(play, referenced);
+
+    while (owned_object_bytes > object_memory_budget) {
+        s16 coldest = 0;
+
+        for (s16 id = 1; id < OBJECT_ID_MAX; id++) {
+            if (object_allocations[id] != NULL && !referenced[id] && !is_persistent_object(id) &&
+                slot_metrics.frame - object_last_used[id] >= OBJECT_COLD_FRAMES &&
+                (coldest == 0 || object_last_used[id] < object_last_used[coldest])) {
+                coldest = id;
+            }
+        }
+        if (coldest == 0) {
+            break;
+        }
+
+        evicted_bytes += object_cache_get_object_size(coldest);
+        num_evicted++;
+        evict_object(coldest);
+    }
+
+    if (num_evicted != 0) {
+        SLOT_LOG(SLOT_LOG_INFO, "Evicted %d objects (%d bytes) to fit in the object memory budget, %d of %d bytes used\n",
+                 num_evicted, evicted_bytes, owned_object_bytes, object_memory_budget);
+    }
+    if (owned_object_bytes > object_memory_budget) {
+        if (!object_budget_warning_printed) {
+            SLOT_LOG(SLOT_LOG_WARNINGS, "Warning: Object memory is %d bytes over the budget and every object left is in use\n",
+                     owned_object_bytes - object_memory_budget);
+            object_budget_warning_printed = true;
+        }
+        object_budget_scan_latched = true;
+        object_budget_scan_bytes = owned_object_bytes;
+        object_budget_scan_generation = slot_sets_generation;
+        object_budget_scan_frame = slot_metrics.frame;
+    }
+}
+
+RECOMP_HOOK("Play_Main") void object_cache_on_play_main(GameState* thisx) {
+    object_cache_enforce_budget((PlayState*)thisx);
+}
+
+// Sets the memory budget for objects loaded through the object cache, in bytes. Zero removes the budget.
+RECOMP_EXPORT void AutoObjectSlots_setObjectMemoryBudget(u32 bytes) {
+    object_memory_budget = bytes;
+}
@@ -0,0 +1,33 @@
+#ifndef __OBJECT_CACHE_H__
+#define __OBJECT_CACHE_H__
+
+#include "global.h"
+
+// Whether objects are loaded through the on-disk decompressed object cache instead of GlobalObjects.
+extern bool object_cache_enabled;
+
+// Limit on the memory used by objects that this mod loads itself, in bytes. Zero means no limit.
+extern u32 object_memory_budget;
+
+// Whether object sets are decompressed in parallel ahead of time when scene and room headers are executed.
+extern bool object_prefetch_enabled;
+
+// Starts loading the given objects in parallel on the native worker pool.
+void object_cache_prefetch(s16* ids, s32 count);
+
+// Waits for the objects started by `object_cache_prefetch` and makes them available.
+void object_cache_prefetch_finish(void);
+
+// Returns the segment for the given object ID, loading it if needed.
+void* object_cache_get_segment(s16 id);
+
+// Returns the segment for the given object ID if it has been resolved already, or NULL otherwise.
+void* object_cache_peek_segment(s16 id);
+
+// Returns the size of the given object's file, or 0 for objects past the vanilla range.
+u32 object_cache_get_object_size(s16 id);
+
+// Points the given object context's persistent objects at their segments in the object context for the current scene.
+void object_cache_set_persistent_segments(ObjectContext* objectCtx);
+
+#endif
@@ -0,0 +1,118 @@
+#include "modding.h"
+#include "global.h"
+#include "recomputils.h"
+
+#include "pollution.h"
+#include "slot_config.h"
+
+// Objects that get appended to the global object context outside of any per-ID set stay there for the rest of the scene,
+// and once all of its slots are used, lookups that need one of them start failing. Every append is recorded along with
+// the hook it happened in, and a scene's appends are reported when the scene ends so that the heaviest consumers can be
+// found and given a set of their own.
+// Lookups from actor and effect hooks only reach the global set when the hook's ID can't get a set of its own, since a
+// trivial ID that misses in the global set gets its own set loaded instead (see promote_trivial_hook_id). Those
+// promotions are recorded as well, since they show which hooks would have filled the global set.
+// The caller is captured explicitly as the Draw or Update function of the actor whose hook is running (see
+// set_hook_actor), rather than from the return address: recompiled code doesn't keep $ra pointing at the guest call
+// site. Appends outside of those hooks are reported without a caller. Callers inside actor and effect overlays are
+// translated back to the overlay's link-time address, so every caller in the report can be symbolized with
+// tools/symbolize_pollution.py.
+bool pollution_tracking_enabled = false;
+
+// The global context only has OBJECT_SLOT_COUNT slots, so a scene can't have more distinct appends than that. Every ID is
+// only promoted once per scene, so a scene with more promotions than fit in the rest has them cut off.
+#define POLLUTION_MAX_RECORDS (OBJECT_SLOT_COUNT * 4)
+
+typedef struct {
+    u32 caller;
+    s16 objectId;
+    // Whether the object went into the hook ID's own set instead of the global set.
+    bool promoted;
+    SlotSetId hookId;
+} PollutionRecord;
+
+PollutionRecord pollution_records[POLLUTION_MAX_RECORDS];
+u32 num_pollution_records = 0;
+
+extern ActorOverlay gActorOverlayTable[ACTOR_ID_MAX];
+extern EffectSsOverlay gEffectSsOverlayTable[EFFECT_SS_TYPE_MAX];
+
+// Translates an address in a loaded overlay to the overlay's link-time address. Addresses outside of overlays are
+// returned as is.
+u32 get_caller_vram(u32 address) {
+    for (s32 i = 0; i < ACTOR_ID_MAX; i++) {
+        ActorOverlay* overlay = &gActorOverlayTable[i];
+        u32 loaded = (u32)overlay->loadedRamAddr;
+        if (loaded != 0 && address >= loaded && address < loaded + ((u32)overlay->vramEnd - (u32)overlay->vramStart)) {
+            return address - loaded + (u32)overlay->vramStart;
+        }
+    }
+    for (s32 i = 0; i < EFFECT_SS_TYPE_MAX; i++) {
+        EffectSsOverlay* overlay = &gEffectSsOverlayTable[i];
+        u32 loaded = (u32)overlay->loadedRamAddr;
+        if (loaded != 0 && address >= loaded && address < loaded + ((u32)overlay->vramEnd - (u32)overlay->vramStart)) {
+            return address - loaded + (u32)overlay->vramStart;
+        }
+    }
+    return address;
+}
+
+void record_pollution(s16 objectId, SlotSetId hookId, bool promoted) {
+    PollutionRecord* record;
+
+    if (!pollution_tracking_enabled || num_pollution_records >= POLLUTION_MAX_RECORDS) {
+        return;
+    }
+
+    // Overlays can be unloaded before the scene ends, so the caller is translated right away.
+    record = &pollution_records[num_pollution_records++];
+    record->caller = get_caller_vram(get_hook_caller());
+    record->objectId = objectId;
+    record->promoted = promoted;
+    record->hookId = hookId;
+    SLOT_LOG_ID(SLOT_LOG_TRACE, hookId, "%s %s 0x%04X, caller 0x%08X, hook %s (ID: 0x%04X)\n",
+                promoted ? "Moved to own set:" : "Appended to global set:", get_obj_define_string(objectId), objectId,
+                record->caller, get_actor_define_string(hookId), hookId);
+}
+
+void pollution_record_global_append(s16 objectId, SlotSetId hookId) {
+    record_pollution(objectId, hookId, false);
+}
+
+void pollution_record_promotion(s16 objectId, SlotSetId hookId) {
+    record_pollution(objectId, hookId, true);
+}
+
+void print_pollution_report(PlayState* play) {
+    u32 num_promoted = 0;
+
+    for (u32 i = 0; i < num_pollution_records; i++) {
+        num_promoted += pollution_records[i].promoted;
+    }
+    SLOT_LOG(SLOT_LOG_INFO,
+             "Global object slot consumers in scene 0x%02X: %d objects appended, %d moved to own sets, %d of %d slots used\n",
+             play->sceneId, num_pollution_records - num_promoted, num_promoted, play->objectCtx.numEntries,
+             OBJECT_SLOT_COUNT);
+    for (u32 i = 0; i < num_pollution_records; i++) {
+        PollutionRecord* record = &pollution_records[i];
+        const char* kind = record->promoted ? "own set" : "global ";
+        if (record->caller != 0) {
+            SLOT_LOG(SLOT_LOG_INFO, "    %s %-24s 0x%04X  caller 0x%08X  hook %-20s (ID: 0x%04X)\n", kind,
+                     get_obj_define_string(record->objectId), record->objectId, record->caller,
+                     get_actor_define_string(record->hookId), record->hookId);
+        } else {
+            SLOT_LOG(SLOT_LOG_INFO, "    %s %-24s 0x%04X  caller unknown     hook %-20s (ID: 0x%04X)\n", kind,
+                     get_obj_define_string(record->objectId), record->objectId, get_actor_define_string(record->hookId),
+                     record->hookId);
+        }
+    }
+}
+
+RECOMP_HOOK("Play_Destroy") void pollution_on_play_destroy(GameState* thisx) {
+    PlayState* play = (PlayState*)thisx;
+
+    if (pollution_tracking_enabled && num_pollution_records != 0) {
+        print_pollution_report(play);
+    }
+    num_pollution_records = 0;
+}
@@ -0,0 +1,17 @@
+#ifndef __POLLUTION_H__
+#define __POLLUTION_H__
+
+#include "global.h"
+#include "auto_slots.h"
+
+// Whether objects appended to the global object context are attributed to the code that looked them up, see pollution.c.
+extern bool pollution_tracking_enabled;
+
+// Records that an object lookup appended an object to the global object context during the hook of the given set ID.
+void pollution_record_global_append(s16 objectId, SlotSetId hookId);
+
+// Records that an object lookup from the hook of the given trivial set ID loaded the ID's own set, where the object went
+// instead of the global object context.
+void pollution_record_promotion(s16 objectId, SlotSetId hookId);
+
+#endif
@@ -0,0 +1,229 @@
+#include "modding.h"
+#include "global.h"
+#include "recomputils.h"
+#include "recompdata.h"
+
+#include "profiler.h"
+#include "native_bridge.h"
+#include "slot_config.h"
+
+// The profiler times the mod's own work: switching sets in the actor and effect hooks, and object lookups. Each sample
+// goes into a log2 histogram for the set ID it was done for, so that slow paths can be attributed to specific actors.
+// Every frame's total is compared against the frame's duration, and frames where the mod took more than
+// PROFILER_HITCH_PERCENT of the frame are reported along with the actor and object responsible for the worst sample.
+// Off by default, since it calls into the native library several times per actor per frame.
+bool profiler_enabled = false;
+
+#define PROFILER_NUM_BUCKETS 24
+#define PROFILER_HITCH_PERCENT 10
+// Frames shorter than this aren't checked for hitches, since a small absolute cost can still be a large share of them.
+#define PROFILER_MIN_HITCH_NS 1000000
+// How often the histograms are printed, in frames.
+#define PROFILER_REPORT_INTERVAL 1200
+#define PROFILER_MAX_DEPTH 64
+
+typedef struct {
+    SlotSetId id;
+    u32 hookSamples;
+    u32 lookupSamples;
+    u64 hookTotal;
+    u64 lookupTotal;
+    u32 hookMax;
+    u32 lookupMax;
+    // Bucket i counts the samples that took at least 2^i and less than 2^(i+1) nanoseconds.
+    u32 hookBuckets[PROFILER_NUM_BUCKETS];
+    u32 lookupBuckets[PROFILER_NUM_BUCKETS];
+} IdProfile;
+
+U32ValueHashmapHandle id_profile_map;
+IdProfile** id_profiles = NULL;
+u32 num_id_profiles = 0;
+u32 id_profiles_capacity = 0;
+
+// Time spent entering the hook at each depth, added to the exit time once the hook returns.
+u32 hook_enter_times[PROFILER_MAX_DEPTH];
+
+typedef struct {
+    u32 start;
+    u32 total;
+    u32 worstHook;
+    SlotSetId worstHookId;
+    u32 worstLookup;
+    SlotSetId worstLookupId;
+    s16 worstLookupObjectId;
+} FrameProfile;
+
+FrameProfile frame_profile;
+u32 profiled_frames = 0;
+
+RECOMP_CALLBACK("*", recomp_on_init) void profiler_on_init() {
+    id_profile_map = recomputil_create_u32_value_hashmap();
+}
+
+u32 profiler_now(void) {
+    return host_clock_ns();
+}
+
+IdProfile* get_id_profile(SlotSetId id) {
+    unsigned long profile;
+    IdProfile* new_profile;
+
+    if (recomputil_u32_value_hashmap_get(id_profile_map, (u32)id, &profile)) {
+        return (IdProfile*)profile;
+    }
+
+    new_profile = recomp_alloc(sizeof(IdProfile));
+    Lib_MemSet(new_profile, 0, sizeof(IdProfile));
+    new_profile->id = id;
+
+    if (num_id_profiles == id_profiles_capacity) {
+        u32 new_capacity = id_profiles_capacity == 0 ? 256 : id_profiles_capacity * 2;
+        IdProfile** new_list = recomp_alloc(new_capacity * sizeof(IdProfile*));
+        for (u32 i = 0; i < num_id_profiles; i++) {
+            new_list[i] = id_profiles[i];
+        }
+        if (id_profiles != NULL) {
+            recomp_free(id_profiles);
+        }
+        id_profiles = new_list;
+        id_profiles_capacity = new_capacity;
+    }
+    id_profiles[num_id_profiles++] = new_profile;
+
+    recomputil_u32_value_hashmap_insert(id_profile_map, (u32)id, (unsigned long)new_profile);
+    return new_profile;
+}
+
+s32 get_bucket(u32 ns) {
+    s32 bucket = 0;
+    while (ns > 1 && bucket < PROFILER_NUM_BUCKETS - 1) {
+        ns >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void profiler_record_hook_enter(s32 depth, u32 start) {
+    if (depth >= 0 && depth < PROFILER_MAX_DEPTH) {
+        hook_enter_times[depth] = profiler_now() - start;
+    }
+}
+
+void profiler_record_hook_exit(s32 depth, SlotSetId id, u32 start) {
+    u32 elapsed = profiler_now() - start;
+    IdProfile* profile;
+
+    if (depth >= 0 && depth < PROFILER_MAX_DEPTH) {
+        elapsed += hook_enter_times[depth];
+    }
+
+    profile = get_id_profile(id);
+    profile->hookSamples++;
+    profile->hookTotal += elapsed;
+    profile->hookBuckets[get_bucket(elapsed)]++;
+    if (elapsed > profile->hookMax) {
+        profile->hookMax = elapsed;
+    }
+
+    frame_profile.total += elapsed;
+    if (elapsed > frame_profile.worstHook) {
+        frame_profile.worstHook = elapsed;
+        frame_profile.worstHookId = id;
+    }
+}
+
+void profiler_record_lookup(SlotSetId id, s16 objectId, u32 start) {
+    u32 elapsed = profiler_now() - start;
+    IdProfile* profile = get_id_profile(id);
+
+    profile->lookupSamples++;
+    profile->lookupTotal += elapsed;
+    profile->lookupBuckets[get_bucket(elapsed)]++;
+    if (elapsed > profile->lookupMax) {
+        profile->lookupMax = elapsed;
+    }
+
+    frame_profile.total += elapsed;
+    if (elapsed > frame_profile.worstLookup) {
+        frame_profile.worstLookup = elapsed;
+        frame_profile.worstLookupId = id;
+        frame_profile.worstLookupObjectId = objectId;
+    }
+}
+
+// Returns the lower bound in nanoseconds of the bucket that contains the given percentile of the samples.
+u32 get_percentile(u32* buckets, u32 num_samples, u32 percent) {
+    u32 target = (num_samples * percent + 99) / 100;
+    u32 count = 0;
+
+    for (s32 i = 0; i < PROFILER_NUM_BUCKETS; i++) {
+        count += buckets[i];
+        if (count >= target) {
+            return 1u << i;
+        }
+    }
+    return 1u << (PROFILER_NUM_BUCKETS - 1);
+}
+
+void print_profile_report(void) {
+    recomp_printf("Auto object slots profile (%d frames):\n", profiled_frames);
+    for (u32 i = 0; i < num_id_profiles; i++) {
+        IdProfile* profile = id_profiles[i];
+        if (profile->hookSamples == 0 && profile->lookupSamples == 0) {
+            continue;
+        }
+        recomp_printf("  %-24s 0x%04X  hooks %7d avg %6dns p50 >=%6dns p99 >=%6dns max %7dns  "
+                      "lookups %6d avg %6dns p99 >=%6dns max %7dns\n",
+                      get_actor_define_string(SLOT_SET_ACTOR_ID(profile->id)), profile->id, profile->hookSamples,
+                      profile->hookSamples != 0 ? (u32)(profile->hookTotal / profile->hookSamples) : 0,
+                      get_percentile(profile->hookBuckets, profile->hookSamples, 50),
+                      get_percentile(profile->hookBuckets, profile->hookSamples, 99), profile->hookMax,
+                      profile->lookupSamples,
+                      profile->lookupSamples != 0 ? (u32)(profile->lookupTotal / profile->lookupSamples) : 0,
+                      get_percentile(profile->lookupBuckets, profile->lookupSamples, 99), profile->lookupMax);
+    }
+}
+
+void check_frame_hitch(u32 frame_time) {
+    if (frame_time < PROFILER_MIN_HITCH_NS || (u64)frame_profile.total * 100 <= (u64)frame_time * PROFILER_HITCH_PERCENT) {
+        return;
+    }
+
+    recomp_printf("Warning: Auto object slots took %dus of a %dus frame\n", frame_profile.total / 1000, frame_time / 1000);
+    if (frame_profile.worstHook != 0) {
+        recomp_printf("    Slowest set switch: %s (ID: 0x%04X) %dus\n",
+                      get_actor_define_string(SLOT_SET_ACTOR_ID(frame_profile.worstHookId)), frame_profile.worstHookId,
+                      frame_profile.worstHook / 1000);
+    }
+    if (frame_profile.worstLookup != 0) {
+        recomp_printf("    Slowest lookup: %s (0x%04X) for %s (ID: 0x%04X) %dus\n",
+                      get_obj_define_string(frame_profile.worstLookupObjectId), frame_profile.worstLookupObjectId,
+                      get_actor_define_string(SLOT_SET_ACTOR_ID(frame_profile.worstLookupId)), frame_profile.worstLookupId,
+                      frame_profile.worstLookup / 1000);
+    }
+}
+
+// Each call to Play_Main is one game frame, so the previous frame is finished off here.
+RECOMP_HOOK("Play_Main") void profiler_on_play_main(GameState* thisx) {
+    u32 now;
+
+    if (!profiler_enabled) {
+        return;
+    }
+    if (!native_library_check("The profiler")) {
+        profiler_enabled = false;
+        return;
+    }
+
+    now = profiler_now();
+    if (profiled_frames != 0) {
+        check_frame_hitch(now - frame_profile.start);
+    }
+    profiled_frames++;
+    if (profiled_frames % PROFILER_REPORT_INTERVAL == 0) {
+        print_profile_report();
+    }
+
+    Lib_MemSet(&frame_profile, 0, sizeof(frame_profile));
+    frame_profile.start = now;
+}
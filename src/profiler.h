@@ -0,0 +1,20 @@
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+#include "global.h"
+#include "auto_slots.h"
+
+// Whether the time spent in the mod's hooks and object lookups is measured, see profiler.c.
+extern bool profiler_enabled;
+
+// Returns the current host time in nanoseconds, for passing as the start time of the functions below.
+u32 profiler_now(void);
+
+// Records the time spent switching sets when entering and exiting an actor or effect hook at the given hook depth.
+void profiler_record_hook_enter(s32 depth, u32 start);
+void profiler_record_hook_exit(s32 depth, SlotSetId id, u32 start);
+
+// Records the time spent looking up an object on behalf of the given set ID.
+void profiler_record_lookup(SlotSetId id, s16 objectId, u32 start);
+
+#endif
@@ -0,0 +1,62 @@
+#include "modding.h"
+#include "global.h"
+
+#include "auto_slots.h"
+#include "object_cache.h"
+
+// Scene and room headers are scanned before they're executed so that every object they're going to need can be
+// decompressed in parallel, instead of one by one as the commands resolve them.
+
+// Upper bound on the number of objects gathered from a single header. Anything past it is loaded on demand as usual.
+#define PREFETCH_LIST_SIZE 128
+
+// The object ID each actor ID was last seen using, plus one so that zero means unknown.
+// Actor profiles live in the actor overlays, so the objects of actors from a spawn list can only be known once an actor
+// with that ID has been initialized.
+s16 learned_actor_object_ids[ACTOR_ID_MAX];
+
+RECOMP_HOOK("Actor_Init") void on_actor_init(Actor* actor, PlayState* play) {
+    if (actor->id < ACTOR_ID_MAX && actor->objectSlot > OBJECT_SLOT_NONE) {
+        learned_actor_object_ids[actor->id] = ABS_ALT(play->objectCtx.slots[actor->objectSlot].id) + 1;
+    }
+}
+
+void add_prefetch_id(s16* ids, s32* count, s16 id) {
+    if (*count < PREFETCH_LIST_SIZE) {
+        ids[*count] = id;
+        (*count)++;
+    }
+}
+
+RECOMP_HOOK("Scene_ExecuteCommands") void on_execute_scene_commands(PlayState* play, SceneCmd* sceneCmd) {
+    s16 ids[PREFETCH_LIST_SIZE];
+    s32 count = 0;
+
+    if (!object_cache_enabled || !object_prefetch_enabled) {
+        return;
+    }
+
+    for (SceneCmd* cmd = sceneCmd; cmd->base.code != SCENE_CMD_ID_END; cmd++) {
+        // Objects from the object list are resolved on their first lookup in lazy mode, so don't load them all up front.
+        if (cmd->base.code == SCENE_CMD_ID_OBJECT_LIST && !lazy_scene_objects_enabled) {
+            s16* object_list = Lib_SegmentedToVirtual(cmd->objectList.segment);
+            for (s32 i = 0; i < cmd->objectList.num; i++) {
+                add_prefetch_id(ids, &count, object_list[i]);
+            }
+        } else if (cmd->base.code == SCENE_CMD_ID_ACTOR_LIST) {
+            ActorEntry* actor_list = Lib_SegmentedToVirtual(cmd->actorList.segment);
+            for (s32 i = 0; i < cmd->actorList.num; i++) {
+                s16 actor_id = actor_list[i].id & 0x1FFF;
+                if (actor_id < ACTOR_ID_MAX && learned_actor_object_ids[actor_id] != 0) {
+                    add_prefetch_id(ids, &count, learned_actor_object_ids[actor_id] - 1);
+                }
+            }
+        }
+    }
+
+    object_cache_prefetch(ids, count);
+}
+
+RECOMP_HOOK_RETURN("Scene_ExecuteCommands") void after_execute_scene_commands() {
+    object_cache_prefetch_finish();
+}
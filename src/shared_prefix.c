@@ -0,0 +1,207 @@
+#include "modding.h"
+#include "global.h"
+#include "recomputils.h"
+#include "recompdata.h"
+
+#include "auto_slots.h"
+#include "object_cache.h"
+#include "shared_prefix.h"
+#include "slot_config.h"
+
+// Some objects end up in almost every per-ID set, e.g. items the player holds up or effects that many actors draw. Each
+// of those sets has its own copy of the object's ID, and the object takes up a window slot in all of them. When a scene
+// ends, the objects in the scene's sets are counted, and the ones that at least half of the sets have are promoted:
+// starting with the next scene, they're appended to the global object context's persistent objects. Every set starts
+// out with the persistent objects, and the persistent part of the window is the same for every set, so switching sets
+// doesn't copy it. Lookups of promoted objects are tracked per set ID, and objects that fewer than a quarter of the sets
+// used get demoted again. Both thresholds are out of the same sets: the ones that needed a set of their own or used a
+// promoted object in the scene that's ending.
+// Off by default, since it changes which objects are persistent and which slots the room object lists start at.
+bool shared_prefix_enabled = false;
+
+// Every promoted object takes a slot away from the room object lists, so only a few objects are promoted at a time, and
+// only as many as fit next to the largest room object list seen in the scene. Scenes that haven't been visited yet get
+// none, since their room object lists aren't known.
+#define SHARED_PREFIX_MAX 6
+// Scenes with fewer sets than this don't say much about which objects are common, so they don't change the promotions.
+#define SHARED_PREFIX_MIN_SETS 8
+#define SHARED_PREFIX_PROMOTE_PERCENT 50
+#define SHARED_PREFIX_DEMOTE_PERCENT 25
+
+s16 shared_prefix_ids[SHARED_PREFIX_MAX];
+u32 num_shared_prefix_ids = 0;
+
+// The set IDs that looked up each promoted object in the current scene, keyed by set ID, and the number of counted sets
+// among them.
+U32ValueHashmapHandle shared_prefix_users_maps[SHARED_PREFIX_MAX];
+SlotSetId shared_prefix_last_user[SHARED_PREFIX_MAX];
+u16 shared_prefix_users[SHARED_PREFIX_MAX];
+
+// Number of counted sets that have each object, and the number of counted sets.
+u16 shared_prefix_set_counts[OBJECT_ID_MAX];
+u32 shared_prefix_num_sets = 0;
+
+bool shared_prefix_room_objects[OBJECT_ID_MAX];
+
+// The largest room object list seen in each scene, plus one so that zero means the scene hasn't been visited.
+u8 shared_prefix_room_list_sizes[SCENE_MAX];
+
+RECOMP_CALLBACK("*", recomp_on_init) void shared_prefix_on_init() {
+    for (u32 i = 0; i < SHARED_PREFIX_MAX; i++) {
+        shared_prefix_users_maps[i] = recomputil_create_u32_value_hashmap();
+        shared_prefix_last_user[i] = SLOT_SET_ID_NONE;
+    }
+}
+
+void reset_shared_prefix_users(void) {
+    for (u32 i = 0; i < SHARED_PREFIX_MAX; i++) {
+        recomputil_destroy_u32_value_hashmap(shared_prefix_users_maps[i]);
+        shared_prefix_users_maps[i] = recomputil_create_u32_value_hashmap();
+        shared_prefix_users[i] = 0;
+        shared_prefix_last_user[i] = SLOT_SET_ID_NONE;
+    }
+}
+
+void shared_prefix_count_set(SlotSetId id, IdSlots* idSlots, s32 prefixLength, bool needsSet) {
+    bool used_prefix = false;
+    unsigned long unused;
+
+    for (u32 i = 0; i < num_shared_prefix_ids; i++) {
+        if (recomputil_u32_value_hashmap_get(shared_prefix_users_maps[i], (u32)id, &unused)) {
+            shared_prefix_users[i]++;
+            used_prefix = true;
+        }
+    }
+    // IDs whose objects are all in the global set only say something about the promoted objects they use.
+    if (!needsSet && !used_prefix) {
+        return;
+    }
+
+    for (s32 i = prefixLength; i < idSlots->numEntries; i++) {
+        s16 objectId = ABS_ALT(idSlots->ids[i]);
+        if (objectId > 0 && objectId < OBJECT_ID_MAX) {
+            shared_prefix_set_counts[objectId]++;
+        }
+    }
+    for (s32 i = OBJECT_SLOT_COUNT; i < OBJECT_SLOT_COUNT + idSlots->numShadowEntries; i++) {
+        s16 objectId = ABS_ALT(idSlots->ids[i]);
+        if (objectId > 0 && objectId < OBJECT_ID_MAX) {
+            shared_prefix_set_counts[objectId]++;
+        }
+    }
+    shared_prefix_num_sets++;
+}
+
+void shared_prefix_update(void) {
+    u32 num_sets = shared_prefix_num_sets;
+    u32 num_kept = 0;
+
+    if (num_sets >= SHARED_PREFIX_MIN_SETS) {
+        // Keep the promoted objects that enough sets still used.
+        for (u32 i = 0; i < num_shared_prefix_ids; i++) {
+            if (shared_prefix_users[i] * 100 >= num_sets * SHARED_PREFIX_DEMOTE_PERCENT) {
+                shared_prefix_ids[num_kept++] = shared_prefix_ids[i];
+            } else {
+                SLOT_LOG(SLOT_LOG_INFO, "Demoting object %-24s 0x%04X from the shared prefix, used by %d of %d sets\n",
+                         get_obj_define_string(shared_prefix_ids[i]), shared_prefix_ids[i], shared_prefix_users[i],
+                         num_sets);
+            }
+        }
+        num_shared_prefix_ids = num_kept;
+
+        // Promote the most common objects that are above the threshold, as long as there's room.
+        while (num_shared_prefix_ids < SHARED_PREFIX_MAX) {
+            s16 best_id = 0;
+
+            for (s16 id = 1; id < OBJECT_ID_MAX; id++) {
+                if (!shared_prefix_room_objects[id] && shared_prefix_set_counts[id] > shared_prefix_set_counts[best_id]) {
+                    best_id = id;
+                }
+            }
+            if (best_id == 0 || shared_prefix_set_counts[best_id] * 100 < num_sets * SHARED_PREFIX_PROMOTE_PERCENT) {
+                break;
+            }
+
+            SLOT_LOG(SLOT_LOG_INFO, "Promoting object %-24s 0x%04X into the shared prefix, used by %d of %d sets\n",
+                     get_obj_define_string(best_id), best_id, shared_prefix_set_counts[best_id], num_sets);
+            shared_prefix_ids[num_shared_prefix_ids++] = best_id;
+            shared_prefix_set_counts[best_id] = 0;
+        }
+    }
+
+    for (s16 id = 0; id < OBJECT_ID_MAX; id++) {
+        shared_prefix_set_counts[id] = 0;
+        shared_prefix_room_objects[id] = false;
+    }
+    shared_prefix_num_sets = 0;
+    reset_shared_prefix_users();
+}
+
+void shared_prefix_append(ObjectContext* objectCtx, s16 sceneId) {
+    s32 room_list_size;
+    s32 max_entries;
+
+    if (sceneId < 0 || sceneId >= SCENE_MAX || shared_prefix_room_list_sizes[sceneId] == 0) {
+        return;
+    }
+    // Leave room for the largest room object list, and leave the last slot free, since Object_SpawnPersistent writes the
+    // next object's address into the slot after it.
+    room_list_size = shared_prefix_room_list_sizes[sceneId] - 1;
+    max_entries = OBJECT_SLOT_COUNT - 1 - room_list_size;
+
+    for (u32 i = 0; i < num_shared_prefix_ids; i++) {
+        s16 id = shared_prefix_ids[i];
+        s32 slot = objectCtx->numEntries;
+        bool present = false;
+
+        for (s32 j = 0; j < objectCtx->numEntries; j++) {
+            if (ABS_ALT(objectCtx->slots[j].id) == id) {
+                present = true;
+                break;
+            }
+        }
+        if (present || slot >= max_entries) {
+            continue;
+        }
+
+        // Promoted objects live in the object cache, so the space for the next persistent object moves up a slot as is.
+        objectCtx->slots[slot + 1].segment = objectCtx->slots[slot].segment;
+        objectCtx->slots[slot].id = id;
+        objectCtx->slots[slot].segment = object_cache_get_segment(id);
+        objectCtx->numEntries++;
+        objectCtx->numPersistentEntries = objectCtx->numEntries;
+    }
+}
+
+void shared_prefix_record_use(s16 objectId) {
+    SlotSetId hook_id = get_hook_set_id();
+    unsigned long unused;
+
+    if (hook_id == AUTO_OBJECT_SLOTS_GLOBAL_SET) {
+        return;
+    }
+    for (u32 i = 0; i < num_shared_prefix_ids; i++) {
+        if (shared_prefix_ids[i] == objectId) {
+            // The users are counted when the scene ends, see shared_prefix_count_set.
+            if (shared_prefix_last_user[i] != hook_id &&
+                !recomputil_u32_value_hashmap_get(shared_prefix_users_maps[i], (u32)hook_id, &unused)) {
+                recomputil_u32_value_hashmap_insert(shared_prefix_users_maps[i], (u32)hook_id, 1);
+            }
+            shared_prefix_last_user[i] = hook_id;
+            return;
+        }
+    }
+}
+
+void shared_prefix_record_room_list(s16 sceneId, s32 numObjects) {
+    if (sceneId >= 0 && sceneId < SCENE_MAX && numObjects + 1 > shared_prefix_room_list_sizes[sceneId]) {
+        shared_prefix_room_list_sizes[sceneId] = numObjects < OBJECT_SLOT_COUNT ? numObjects + 1 : OBJECT_SLOT_COUNT + 1;
+    }
+}
+
+void shared_prefix_record_room_object(s16 objectId) {
+    objectId = ABS_ALT(objectId);
+    if (objectId > 0 && objectId < OBJECT_ID_MAX) {
+        shared_prefix_room_objects[objectId] = true;
+    }
+}
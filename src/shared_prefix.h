@@ -0,0 +1,28 @@
+#ifndef __SHARED_PREFIX_H__
+#define __SHARED_PREFIX_H__
+
+#include "global.h"
+#include "auto_slots.h"
+
+// Whether objects that most sets use are promoted into the persistent objects that every set starts with, see
+// shared_prefix.c.
+extern bool shared_prefix_enabled;
+
+// Counts the objects of an ID's set in the scene that's ending, if the ID needed its set or used a promoted object.
+// Entries before prefixLength are skipped.
+void shared_prefix_count_set(SlotSetId id, IdSlots* idSlots, s32 prefixLength, bool needsSet);
+// Picks the objects to promote for the next scene from the sets counted since the last call.
+void shared_prefix_update(void);
+// Appends the promoted objects to the given object context's persistent objects, unless they're in it already, as far as
+// the scene's room object lists leave room for them.
+void shared_prefix_append(ObjectContext* objectCtx, s16 sceneId);
+
+// Records that the given persistent object was looked up, so that promoted objects that stop being used get demoted.
+void shared_prefix_record_use(s16 objectId);
+// Records the size of a room's object list in the given scene.
+void shared_prefix_record_room_list(s16 sceneId, s32 numObjects);
+// Records that an object was loaded from a room's object list. Room objects are specific to their scene, so they never
+// get promoted.
+void shared_prefix_record_room_object(s16 objectId);
+
+#endif
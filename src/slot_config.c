@@ -0,0 +1,129 @@
+#include "modding.h"
+#include "global.h"
+#include "recomputils.h"
+#include "recompconfig.h"
+
+#include "auto_slots.h"
+#include "object_cache.h"
+#include "metrics.h"
+#include "profiler.h"
+#include "pollution.h"
+#include "shared_prefix.h"
+#include "slot_verify.h"
+#include "slot_config.h"
+
+// The slot policies and diagnostics are read from the config options in mod.toml, so they can be tuned from the mod menu
+// without a rebuild. The options are read into plain globals at startup and again whenever gameplay starts, and the hot
+// paths only ever compare those. Options whose state outlives a scene (the shared prefix, lazy room objects and the
+// verification reference sets) are only read at startup, since switching them mid-session would leave that state stale.
+
+u32 slot_auto_load_scope = SLOT_AUTO_LOAD_EVERYWHERE;
+u32 slot_eviction_policy = SLOT_EVICTION_ROUND_ROBIN;
+u32 slot_log_level = SLOT_LOG_INFO;
+
+extern bool warmup_enabled;
+
+// The memory budget can also be set through the API, so the option only overrides it when the option itself changes.
+u32 applied_memory_budget_mb = 0;
+
+// Set IDs that messages about a single set are limited to, one bit per vanilla actor ID. Messages about sets outside the
+// vanilla actor range are only logged without a filter.
+u32 log_filter_bits[(ACTOR_ID_MAX + 31) / 32];
+bool log_filter_active = false;
+
+bool slot_log_id_enabled(SlotSetId id) {
+    s16 actor_id = SLOT_SET_ACTOR_ID(id);
+
+    if (!log_filter_active) {
+        return true;
+    }
+    return actor_id >= 0 && actor_id < ACTOR_ID_MAX && (log_filter_bits[actor_id / 32] & (1 << (actor_id % 32)));
+}
+
+s32 hex_digit_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+// Parses a list of hexadecimal actor IDs, e.g. "0x0010, 1A8". Anything that isn't a hex digit separates IDs.
+void parse_log_filter(const char* str) {
+    u32 value = 0;
+    bool in_number = false;
+
+    for (u32 i = 0; i < ARRAY_COUNT(log_filter_bits); i++) {
+        log_filter_bits[i] = 0;
+    }
+    log_filter_active = false;
+
+    for (const char* c = str; ; c++) {
+        s32 digit;
+
+        // Skip the x of a 0x prefix.
+        if ((*c == 'x' || *c == 'X') && in_number && value == 0) {
+            continue;
+        }
+        digit = hex_digit_value(*c);
+        if (digit >= 0) {
+            value = (value << 4) | digit;
+            in_number = true;
+        } else {
+            if (in_number && value < ACTOR_ID_MAX) {
+                log_filter_bits[value / 32] |= 1 << (value % 32);
+                log_filter_active = true;
+            }
+            value = 0;
+            in_number = false;
+        }
+        if (*c == '\0') {
+            break;
+        }
+    }
+}
+
+void slot_config_apply(void) {
+    u32 memory_budget_mb;
+    char* log_filter;
+
+    slot_auto_load_scope = recomp_get_config_u32("auto_load_scope");
+    slot_eviction_policy = recomp_get_config_u32("eviction_policy");
+    object_cache_enabled = recomp_get_config_u32("object_cache") != 0;
+    object_prefetch_enabled = recomp_get_config_u32("object_prefetch") != 0;
+    warmup_enabled = recomp_get_config_u32("warmup") != 0;
+    warmup_budget_ns = recomp_get_config_u32("load_budget_us") * 1000;
+
+    memory_budget_mb = recomp_get_config_u32("memory_budget_mb");
+    if (memory_budget_mb != applied_memory_budget_mb) {
+        object_memory_budget = memory_budget_mb * 1024 * 1024;
+        applied_memory_budget_mb = memory_budget_mb;
+    }
+
+    slot_log_level = recomp_get_config_u32("log_level");
+    log_filter = recomp_get_config_string("log_filter");
+    if (log_filter != NULL) {
+        parse_log_filter(log_filter);
+        recomp_free_config_string(log_filter);
+    }
+
+    metrics_enabled = recomp_get_config_u32("metrics") != 0;
+    profiler_enabled = recomp_get_config_u32("profiler") != 0;
+    pollution_tracking_enabled = recomp_get_config_u32("pollution_tracking") != 0;
+}
+
+RECOMP_CALLBACK("*", recomp_on_init) void slot_config_on_init() {
+    lazy_scene_objects_enabled = recomp_get_config_u32("lazy_scene_objects") != 0;
+    shared_prefix_enabled = recomp_get_config_u32("shared_prefix") != 0;
+    slot_verification_enabled = recomp_get_config_u32("slot_verification") != 0;
+    slot_config_apply();
+}
+
+RECOMP_HOOK("Play_Init") void slot_config_on_play_init(GameState* thisx) {
+    slot_config_apply();
+}
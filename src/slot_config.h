@@ -0,0 +1,64 @@
+#ifndef __SLOT_CONFIG_H__
+#define __SLOT_CONFIG_H__
+
+#include "global.h"
+#include "recomputils.h"
+#include "auto_slots.h"
+
+// Slot policies selected through the mod's config options, see slot_config.c. The values match the order of the options
+// in mod.toml.
+
+// Where lookups that miss may load objects into the object context.
+typedef enum {
+    // Into whichever set is loaded, including the global object context.
+    SLOT_AUTO_LOAD_EVERYWHERE,
+    // Only while a per-ID set is loaded, so the global object context is never grown.
+    SLOT_AUTO_LOAD_ID_SETS
+} SlotAutoLoadScope;
+
+// How a window slot is picked to make room once a set's window is full.
+typedef enum {
+    SLOT_EVICTION_ROUND_ROBIN,
+    SLOT_EVICTION_LEAST_RECENTLY_USED,
+    // The window isn't made room in, so lookups fail once it's full like they do in vanilla.
+    SLOT_EVICTION_OFF
+} SlotEvictionPolicy;
+
+typedef enum {
+    SLOT_LOG_OFF,
+    SLOT_LOG_WARNINGS,
+    SLOT_LOG_INFO,
+    // Also logs every set switch.
+    SLOT_LOG_TRACE
+} SlotLogLevel;
+
+extern u32 slot_auto_load_scope;
+extern u32 slot_eviction_policy;
+extern u32 slot_log_level;
+
+// Time spent resolving objects ahead of time per frame, see warmup.c.
+extern u32 warmup_budget_ns;
+
+// Reads the config options and applies them. Runs at startup and whenever gameplay starts, so changes made in the mod
+// menu take effect on the next scene.
+void slot_config_apply(void);
+
+// Returns false if the trace filter is set and the given set ID isn't in it.
+bool slot_log_id_enabled(SlotSetId id);
+
+#define SLOT_LOG(level, ...)                   \
+    do {                                       \
+        if (slot_log_level >= (level)) {       \
+            recomp_printf(__VA_ARGS__);        \
+        }                                      \
+    } while (0)
+
+// Same as SLOT_LOG, for messages about a single set that the trace filter applies to.
+#define SLOT_LOG_ID(level, id, ...)                                     \
+    do {                                                                \
+        if (slot_log_level >= (level) && slot_log_id_enabled(id)) {     \
+            recomp_printf(__VA_ARGS__);                                 \
+        }                                                               \
+    } while (0)
+
+#endif
@@ -0,0 +1,169 @@
+#include "modding.h"
+#include "global.h"
+#include "recomputils.h"
+#include "recompdata.h"
+
+#include "auto_slots.h"
+#include "object_cache.h"
+#include "slot_verify.h"
+#include "slot_config.h"
+
+// Debug mode that checks the optimized set switching against the original algorithm, which copies the whole window into
+// the outgoing set and out of the incoming set on every switch. The reference keeps its own copy of every set's window
+// and of the global set, runs the full copies alongside load_slots and unload_slots, and compares its result with the
+// object context and the per-ID sets after every switch. Any difference is reported along with the set ID and stack
+// depth, and the reference is then resynchronized so that one bug is only reported once.
+// Shadow entries aren't part of the object context, so only the windows are compared.
+bool slot_verification_enabled = false;
+
+typedef struct {
+    // Reference sets from before the current scene's sets were reset are stale, and are reinitialized on first use.
+    u32 generation;
+    u8 numEntries;
+    s16 ids[OBJECT_SLOT_COUNT];
+} RefSlots;
+
+U32ValueHashmapHandle ref_slots_map;
+RefSlots ref_global_slots;
+u32 ref_generation = 1;
+
+RECOMP_CALLBACK("*", recomp_on_init) void slot_verify_on_init() {
+    ref_slots_map = recomputil_create_u32_value_hashmap();
+}
+
+void copy_window_to_ref(ObjectContext* objectCtx, RefSlots* ref) {
+    for (s32 i = 0; i < OBJECT_SLOT_COUNT; i++) {
+        ref->ids[i] = i < objectCtx->numEntries ? objectCtx->slots[i].id : 0;
+    }
+    ref->numEntries = objectCtx->numEntries;
+}
+
+void copy_set_to_ref(IdSlots* id_slots, RefSlots* ref) {
+    for (s32 i = 0; i < OBJECT_SLOT_COUNT; i++) {
+        ref->ids[i] = i < id_slots->numEntries ? id_slots->ids[i] : 0;
+    }
+    ref->numEntries = id_slots->numEntries;
+}
+
+// Returns the reference set for an ID, starting it off as a copy of the ID's set if it's new or stale.
+RefSlots* get_ref_slots(SlotSetId id, IdSlots* id_slots) {
+    unsigned long found;
+    RefSlots* ref;
+
+    if (recomputil_u32_value_hashmap_get(ref_slots_map, (u32)id, &found)) {
+        ref = (RefSlots*)found;
+    } else {
+        ref = recomp_alloc(sizeof(RefSlots));
+        ref->generation = 0;
+        recomputil_u32_value_hashmap_insert(ref_slots_map, (u32)id, (unsigned long)ref);
+    }
+
+    if (ref->generation != ref_generation) {
+        copy_set_to_ref(id_slots, ref);
+        ref->generation = ref_generation;
+    }
+    return ref;
+}
+
+void report_mismatch(const char* what, SlotSetId id, s32 depth, s32 slot, s16 actual, s16 expected) {
+    if (slot == OBJECT_SLOT_COUNT) {
+        SLOT_LOG(SLOT_LOG_WARNINGS, "Warning: Slot verification failed %s %-20s (ID: 0x%04X) at depth %d: %d entries, expected %d\n",
+                 what, get_actor_define_string(SLOT_SET_ACTOR_ID(id)), id, depth, actual, expected);
+    } else {
+        SLOT_LOG(SLOT_LOG_WARNINGS, "Warning: Slot verification failed %s %-20s (ID: 0x%04X) at depth %d: slot %d is 0x%04X, expected 0x%04X\n",
+                 what, get_actor_define_string(SLOT_SET_ACTOR_ID(id)), id, depth, slot, actual, expected);
+    }
+}
+
+// Compares the object context's window with a reference set. Returns false and resynchronizes the reference if they
+// differ.
+bool verify_window(ObjectContext* objectCtx, RefSlots* ref, const char* what, SlotSetId id, s32 depth) {
+    bool matches = true;
+
+    if (objectCtx->numEntries != ref->numEntries) {
+        report_mismatch(what, id, depth, OBJECT_SLOT_COUNT, objectCtx->numEntries, ref->numEntries);
+        matches = false;
+    } else {
+        for (s32 i = 0; i < objectCtx->numEntries; i++) {
+            if (objectCtx->slots[i].id != ref->ids[i]) {
+                report_mismatch(what, id, depth, i, objectCtx->slots[i].id, ref->ids[i]);
+                matches = false;
+                break;
+            }
+        }
+    }
+
+    // Segments are never copied by the reference, but a loaded segment has to be the one resolved for the object.
+    for (s32 i = 0; i < objectCtx->numEntries; i++) {
+        void* segment = objectCtx->slots[i].segment;
+        if (segment != NULL && segment != object_cache_peek_segment(ABS_ALT(objectCtx->slots[i].id))) {
+            SLOT_LOG(SLOT_LOG_WARNINGS, "Warning: Slot verification failed %s %-20s (ID: 0x%04X) at depth %d: slot %d has a stale segment\n",
+                     what, get_actor_define_string(SLOT_SET_ACTOR_ID(id)), id, depth, i);
+            matches = false;
+            break;
+        }
+    }
+
+    if (!matches) {
+        copy_window_to_ref(objectCtx, ref);
+    }
+    return matches;
+}
+
+// Compares a per-ID set's window with its reference set. Returns false and resynchronizes the reference if they differ.
+bool verify_set(IdSlots* id_slots, RefSlots* ref, const char* what, SlotSetId id, s32 depth) {
+    if (id_slots->numEntries != ref->numEntries) {
+        report_mismatch(what, id, depth, OBJECT_SLOT_COUNT, id_slots->numEntries, ref->numEntries);
+        copy_set_to_ref(id_slots, ref);
+        return false;
+    }
+    for (s32 i = 0; i < id_slots->numEntries; i++) {
+        if (id_slots->ids[i] != ref->ids[i]) {
+            report_mismatch(what, id, depth, i, id_slots->ids[i], ref->ids[i]);
+            copy_set_to_ref(id_slots, ref);
+            return false;
+        }
+    }
+    return true;
+}
+
+void verify_before_load(ObjectContext* objectCtx, SlotSetId parentId, IdSlots* parentSet) {
+    // The reference always saves the outgoing window, whether or not it was modified.
+    if (parentId == SLOT_SET_ID_NONE) {
+        copy_window_to_ref(objectCtx, &ref_global_slots);
+    } else {
+        copy_window_to_ref(objectCtx, get_ref_slots(parentId, parentSet));
+    }
+}
+
+void verify_after_load(ObjectContext* objectCtx, SlotSetId id, IdSlots* idSet, s32 depth) {
+    verify_window(objectCtx, get_ref_slots(id, idSet), "after loading", id, depth);
+}
+
+void verify_before_unload(ObjectContext* objectCtx, SlotSetId id, IdSlots* idSet) {
+    copy_window_to_ref(objectCtx, get_ref_slots(id, idSet));
+}
+
+void verify_after_unload(ObjectContext* objectCtx, SlotSetId id, IdSlots* idSet, SlotSetId parentId, IdSlots* parentSet,
+                         s32 depth) {
+    // The set has to hold what the window held when it was unloaded, even if writing it back was skipped.
+    verify_set(idSet, get_ref_slots(id, idSet), "writing back", id, depth);
+
+    if (parentId == SLOT_SET_ID_NONE) {
+        verify_window(objectCtx, &ref_global_slots, "restoring the global set after", id, depth);
+    } else {
+        verify_window(objectCtx, get_ref_slots(parentId, parentSet), "restoring the parent set after", id, depth);
+    }
+}
+
+void verify_set_changed(SlotSetId id) {
+    unsigned long found;
+
+    if (recomputil_u32_value_hashmap_get(ref_slots_map, (u32)id, &found)) {
+        ((RefSlots*)found)->generation = 0;
+    }
+}
+
+void verify_reset(void) {
+    ref_generation++;
+}
@@ -0,0 +1,30 @@
+#ifndef __SLOT_VERIFY_H__
+#define __SLOT_VERIFY_H__
+
+#include "global.h"
+#include "auto_slots.h"
+
+// Whether every set switch is checked against the full copy reference algorithm, see slot_verify.c.
+extern bool slot_verification_enabled;
+
+// Called by load_slots before the new set is loaded, with the set that's currently loaded. parentId is SLOT_SET_ID_NONE
+// if the global set is loaded.
+void verify_before_load(ObjectContext* objectCtx, SlotSetId parentId, IdSlots* parentSet);
+// Called by load_slots once the given ID's set is loaded, at the given stack depth.
+void verify_after_load(ObjectContext* objectCtx, SlotSetId id, IdSlots* idSet, s32 depth);
+
+// Called by unload_slots before the given ID's set is unloaded.
+void verify_before_unload(ObjectContext* objectCtx, SlotSetId id, IdSlots* idSet);
+// Called by unload_slots once the set below the given ID's set is loaded again. idSet is the set the ID is bound to
+// afterwards.
+void verify_after_unload(ObjectContext* objectCtx, SlotSetId id, IdSlots* idSet, SlotSetId parentId, IdSlots* parentSet,
+                         s32 depth);
+
+// Called when a set is changed while it isn't loaded, which the reference can't follow, so that its reference set is
+// taken from the set again.
+void verify_set_changed(SlotSetId id);
+
+// Drops the reference sets when the sets are reset for a new scene.
+void verify_reset(void);
+
+#endif
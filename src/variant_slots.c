@@ -0,0 +1,101 @@
+#include "modding.h"
+#include "global.h"
+#include "recompdata.h"
+#include "z64recomp_api.h"
+
+#include "auto_slots.h"
+
+// Some actor IDs use completely different objects depending on their params, e.g. enemies with several variants. With a
+// single set per actor ID, that set ends up holding every variant's objects. Actor IDs with a variant mask get a
+// separate set for every distinct value of `params & mask` instead.
+
+// Variant masks for vanilla actor IDs, indexed by actor ID. Zero means the ID has a single set.
+u16 variant_masks[ACTOR_ID_MAX];
+
+// Variant masks for actor IDs added by other mods.
+U32ValueHashmapHandle modded_variant_masks;
+
+// The set ID each actor was spawned with, so that actors that reuse their params for other state stay in one set.
+ActorExtensionId actor_set_id_extension;
+
+typedef struct {
+    s16 actorId;
+    u16 mask;
+} VariantMaskEntry;
+
+// Pots pick between the dungeon keep's pot and the regular and race pot objects with their type bits.
+static VariantMaskEntry default_variant_masks[] = {
+    { ACTOR_OBJ_TSUBO, 0x0180 },
+};
+
+RECOMP_CALLBACK("*", recomp_on_init) void variant_slots_on_init() {
+    modded_variant_masks = recomputil_create_u32_value_hashmap();
+    actor_set_id_extension = z64recomp_extend_actor_all(sizeof(SlotSetId));
+
+    for (u32 i = 0; i < ARRAY_COUNT(default_variant_masks); i++) {
+        variant_masks[default_variant_masks[i].actorId] = default_variant_masks[i].mask;
+    }
+}
+
+u16 get_variant_mask(s16 actorId) {
+    unsigned long mask;
+
+    if (actorId < 0) {
+        return 0;
+    }
+    if (actorId < ACTOR_ID_MAX) {
+        return variant_masks[actorId];
+    }
+    if (recomputil_u32_value_hashmap_get(modded_variant_masks, (u32)actorId, &mask)) {
+        return mask;
+    }
+    return 0;
+}
+
+SlotSetId get_spawn_set_id(s16 actorId, s16 params) {
+    u16 mask = get_variant_mask(actorId);
+    u32 variant;
+
+    if (mask == 0) {
+        return actorId;
+    }
+
+    // Folded into 15 bits so that set IDs stay positive. Variants that fold to the same key just share a set.
+    variant = (u16)params & mask;
+    variant = (variant & 0x7FFF) ^ (variant >> 15);
+    return SLOT_SET_ID(actorId, variant);
+}
+
+SlotSetId get_actor_set_id(Actor* actor) {
+    SlotSetId* set_id;
+
+    if (get_variant_mask(actor->id) == 0) {
+        return actor->id;
+    }
+    set_id = z64recomp_get_extended_actor_data(actor, actor_set_id_extension);
+    if (set_id == NULL || SLOT_SET_ACTOR_ID(*set_id) != actor->id) {
+        return get_spawn_set_id(actor->id, actor->params);
+    }
+    return *set_id;
+}
+
+RECOMP_HOOK("Actor_Init") void on_actor_init_variant(Actor* actor, PlayState* play) {
+    SlotSetId* set_id = z64recomp_get_extended_actor_data(actor, actor_set_id_extension);
+
+    if (set_id != NULL) {
+        *set_id = get_spawn_set_id(actor->id, actor->params);
+    }
+}
+
+// Sets the params mask that selects which set actors with the given ID use. Actors whose `params & mask` differ get
+// separate sets, which keeps each variant's set small. Only affects sets loaded after the call.
+RECOMP_EXPORT void AutoObjectSlots_setVariantMask(s16 actorId, u16 mask) {
+    if (actorId < 0) {
+        return;
+    }
+    if (actorId < ACTOR_ID_MAX) {
+        variant_masks[actorId] = mask;
+    } else {
+        recomputil_u32_value_hashmap_insert(modded_variant_masks, (u32)actorId, mask);
+    }
+}
@@ -0,0 +1,130 @@
+#include "modding.h"
+#include "global.h"
+#include "recomputils.h"
+
+#include "auto_slots.h"
+#include "object_cache.h"
+#include "profiler.h"
+#include "slot_config.h"
+
+// Objects that the first gameplay scene is going to need are resolved ahead of time while the title screen and file
+// select are running, so that the first frames in control of the player don't pay for them. The work is spread out over
+// frames with a time budget, and whatever hasn't been resolved by the time gameplay starts is resolved on demand as usual.
+
+bool warmup_enabled = true;
+
+// Time spent resolving objects per frame, set through the load budget option.
+u32 warmup_budget_ns = 4000000;
+
+// Link's form objects, which are looked up by actors that draw or copy Link in each form.
+static s16 default_warmup_objects[] = {
+    OBJECT_LINK_CHILD, OBJECT_LINK_GORON, OBJECT_LINK_ZORA, OBJECT_LINK_NUTS, OBJECT_LINK_BOY,
+};
+
+// The object each actor ID was last seen using, see scene_prefetch.c.
+extern s16 learned_actor_object_ids[ACTOR_ID_MAX];
+
+// Objects added through AutoObjectSlots_addWarmupObjects.
+s16* extra_warmup_objects = NULL;
+u32 num_extra_warmup_objects = 0;
+u32 extra_warmup_objects_capacity = 0;
+
+s16 warmup_queue[OBJECT_ID_MAX];
+u32 warmup_queue_length = 0;
+u32 warmup_cursor = 0;
+bool warmup_queue_built = false;
+u8 warmup_queued[(OBJECT_ID_MAX + 7) / 8];
+
+void queue_warmup_object(s16 id) {
+    if (id <= 0 || id >= OBJECT_ID_MAX || (warmup_queued[id / 8] & (1 << (id % 8))) ||
+        object_cache_peek_segment(id) != NULL) {
+        return;
+    }
+    warmup_queued[id / 8] |= 1 << (id % 8);
+    warmup_queue[warmup_queue_length++] = id;
+}
+
+void build_warmup_queue(void) {
+    warmup_queue_length = 0;
+    warmup_cursor = 0;
+    Lib_MemSet(warmup_queued, 0, sizeof(warmup_queued));
+
+    for (u32 i = 0; i < ARRAY_COUNT(default_warmup_objects); i++) {
+        queue_warmup_object(default_warmup_objects[i]);
+    }
+    for (u32 i = 0; i < num_extra_warmup_objects; i++) {
+        queue_warmup_object(extra_warmup_objects[i]);
+    }
+    for (u32 i = 0; i < get_num_registered_objects(); i++) {
+        queue_warmup_object(get_registered_object_id(i));
+    }
+    // Objects learned from actors earlier in the session, e.g. when returning to the title screen after a game over.
+    for (s32 i = 0; i < ACTOR_ID_MAX; i++) {
+        if (learned_actor_object_ids[i] != 0) {
+            queue_warmup_object(learned_actor_object_ids[i] - 1);
+        }
+    }
+
+    warmup_queue_built = true;
+    if (warmup_queue_length != 0) {
+        SLOT_LOG(SLOT_LOG_INFO, "Warming up %d objects\n", warmup_queue_length);
+    }
+}
+
+void run_warmup(void) {
+    u32 start;
+
+    if (!warmup_enabled) {
+        return;
+    }
+
+    if (!warmup_queue_built) {
+        build_warmup_queue();
+        // With the object cache, the whole queue gets decompressed in parallel and is collected on the next frame.
+        if (object_cache_enabled) {
+            object_cache_prefetch(warmup_queue, warmup_queue_length);
+            return;
+        }
+    }
+
+    start = profiler_now();
+    while (warmup_cursor < warmup_queue_length) {
+        object_cache_get_segment(warmup_queue[warmup_cursor++]);
+        if (profiler_now() - start >= warmup_budget_ns) {
+            break;
+        }
+    }
+}
+
+RECOMP_HOOK("ConsoleLogo_Main") void warmup_on_console_logo_main(GameState* thisx) {
+    run_warmup();
+}
+
+RECOMP_HOOK("FileSelect_Main") void warmup_on_file_select_main(GameState* thisx) {
+    run_warmup();
+}
+
+// Rebuild the queue the next time the title screen or file select run, to pick up objects learned in the meantime.
+RECOMP_HOOK("Play_Init") void warmup_on_play_init(GameState* thisx) {
+    warmup_queue_built = false;
+}
+
+// Adds objects to resolve ahead of time while the title screen and file select are running.
+// Call it from a `recomp_on_init` callback.
+RECOMP_EXPORT void AutoObjectSlots_addWarmupObjects(s16* objectIds, u32 count) {
+    for (u32 i = 0; i < count; i++) {
+        if (num_extra_warmup_objects == extra_warmup_objects_capacity) {
+            u32 new_capacity = extra_warmup_objects_capacity == 0 ? 64 : extra_warmup_objects_capacity * 2;
+            s16* new_objects = recomp_alloc(new_capacity * sizeof(s16));
+            for (u32 j = 0; j < num_extra_warmup_objects; j++) {
+                new_objects[j] = extra_warmup_objects[j];
+            }
+            if (extra_warmup_objects != NULL) {
+                recomp_free(extra_warmup_objects);
+            }
+            extra_warmup_objects = new_objects;
+            extra_warmup_objects_capacity = new_capacity;
+        }
+        extra_warmup_objects[num_extra_warmup_objects++] = objectIds[i];
+    }
+}
@@ -0,0 +1,105 @@
+// Follows the slot manager counters that the mod publishes through the native library's shared memory region.
+// Prints one line per interval with the per-second rates of the running totals and the current stack depth, optionally
+// followed by the largest per-ID sets.
+//
+// Usage: metrics_tail [-i interval_ms] [-s num_sets]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../native/metrics_layout.h"
+#include "../native/platform.h"
+
+#define METRICS_NAME_ENTRY(name, str) str,
+static const char* counter_names[] = { METRICS_COUNTERS(METRICS_NAME_ENTRY) };
+#undef METRICS_NAME_ENTRY
+
+static int is_total_counter(int index) {
+    return index != METRIC_STACK_DEPTH && index != METRIC_MAX_STACK_DEPTH && index != METRIC_NUM_SETS &&
+           index != METRIC_NUM_SHARED_SETS;
+}
+
+// Copies a consistent snapshot of the region, retrying while the writer is in the middle of an update.
+static void read_snapshot(const MetricsRegion* region, MetricsRegion* out) {
+    uint32_t before;
+    uint32_t after;
+
+    do {
+        before = __atomic_load_n(&region->sequence, __ATOMIC_ACQUIRE);
+        memcpy(out, region, sizeof(MetricsRegion));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&region->sequence, __ATOMIC_RELAXED);
+    } while ((before & 1) != 0 || before != after);
+}
+
+static int compare_set_sizes(const void* a, const void* b) {
+    const MetricsSetSize* set_a = a;
+    const MetricsSetSize* set_b = b;
+    int size_a = set_a->num_entries + set_a->num_shadow_entries;
+    int size_b = set_b->num_entries + set_b->num_shadow_entries;
+    return size_b - size_a;
+}
+
+int main(int argc, char** argv) {
+    int interval_ms = 1000;
+    int num_top_sets = 0;
+    const MetricsRegion* region;
+    static MetricsRegion previous;
+    static MetricsRegion current;
+
+    // Parsed by hand rather than with getopt, which isn't available on Windows.
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            interval_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            num_top_sets = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [-i interval_ms] [-s num_sets]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (interval_ms <= 0) {
+        interval_ms = 1000;
+    }
+
+    region = native_shared_map(METRICS_SHM_NAME, sizeof(MetricsRegion), 0);
+    if (region == NULL) {
+        fprintf(stderr, "Couldn't open %s, is the game running with metrics enabled?\n", METRICS_SHM_NAME);
+        return 1;
+    }
+    if (region->magic != METRICS_MAGIC || region->version != METRICS_VERSION) {
+        fprintf(stderr, "Unexpected metrics region version\n");
+        return 1;
+    }
+
+    read_snapshot(region, &previous);
+    while (1) {
+        double seconds = interval_ms / 1000.0;
+
+        native_sleep_ms(interval_ms);
+        read_snapshot(region, &current);
+
+        for (int i = 0; i < METRICS_NUM_COUNTERS; i++) {
+            if (is_total_counter(i)) {
+                printf("%s %.0f/s  ", counter_names[i], (current.counters[i] - previous.counters[i]) / seconds);
+            } else {
+                printf("%s %u  ", counter_names[i], current.counters[i]);
+            }
+        }
+        printf("\n");
+
+        if (num_top_sets > 0 && current.num_sets > 0) {
+            uint32_t count = current.num_sets < METRICS_MAX_SETS ? current.num_sets : METRICS_MAX_SETS;
+            qsort(current.sets, count, sizeof(MetricsSetSize), compare_set_sizes);
+            for (uint32_t i = 0; i < count && i < (uint32_t)num_top_sets; i++) {
+                printf("    set 0x%08X: %u entries, %u shadow, %u bytes\n", current.sets[i].id,
+                       current.sets[i].num_entries, current.sets[i].num_shadow_entries, current.sets[i].num_bytes);
+            }
+        }
+        fflush(stdout);
+        previous = current;
+    }
+
+    return 0;
+}
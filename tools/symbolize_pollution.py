@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+"""Symbolizes the global object slot consumer reports that the mod prints when a scene ends.
+
+Reads the game's log from stdin (or the files given) and appends the function each `caller 0x...` address belongs to,
+using the function symbols in Zelda64RecompSyms/mm.us.rev1.syms.toml. Callers inside overlays are reported by the mod at
+the overlay's link-time address, so they resolve the same way as the static code. Each function is printed along with
+the name of the section it's in, as given in the symbols file.
+
+Usage: symbolize_pollution.py [-s syms.toml] [log ...]
+"""
+
+import argparse
+import bisect
+import fileinput
+import os
+import re
+
+REPO_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_SYMS = os.path.join(REPO_DIR, "Zelda64RecompSyms", "mm.us.rev1.syms.toml")
+
+SECTION_RE = re.compile(r'^\s*name\s*=\s*"([^"]+)"')
+FUNCTION_RE = re.compile(r'name\s*=\s*"([^"]+)"\s*,\s*vram\s*=\s*(0x[0-9A-Fa-f]+)\s*,\s*size\s*=\s*(0x[0-9A-Fa-f]+)')
+CALLER_RE = re.compile(r"caller (0x[0-9A-Fa-f]{8})")
+
+
+def load_functions(path):
+    functions = []
+    section = ""
+    with open(path) as syms:
+        for line in syms:
+            match = FUNCTION_RE.search(line)
+            if match:
+                functions.append((int(match.group(2), 16), int(match.group(3), 16), match.group(1), section))
+                continue
+            match = SECTION_RE.match(line)
+            if match:
+                section = match.group(1)
+    functions.sort()
+    return functions
+
+
+def symbolize(functions, starts, address):
+    index = bisect.bisect_right(starts, address) - 1
+    if index >= 0:
+        vram, size, name, section = functions[index]
+        if address < vram + size:
+            return "{}+0x{:X} ({})".format(name, address - vram, section)
+    return "?"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-s", "--syms", default=DEFAULT_SYMS, help="function symbols file")
+    parser.add_argument("logs", nargs="*", help="log files, stdin if none are given")
+    args = parser.parse_args()
+
+    functions = load_functions(args.syms)
+    starts = [function[0] for function in functions]
+
+    for line in fileinput.input(args.logs):
+        line = line.rstrip("\n")
+        match = CALLER_RE.search(line)
+        if match:
+            line += "  " + symbolize(functions, starts, int(match.group(1), 16))
+        print(line)
+
+
+if __name__ == "__main__":
+    main()